@@ -0,0 +1,94 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "heap.h"
+#include "external_heap.h"
+
+/**
+  * Check the ExternalHeap against an in-memory BinaryHeap on a random sequence of 'ops' pushes and pops,
+  * with a buffer of 'capacity' elements. Returns true if every pop returned the same element
+  */
+bool check(const std::size_t ops, const std::size_t capacity) {
+    ExternalHeap<long long, Less<long long>> external{capacity};
+    BinaryHeap<long long, Less<long long>> reference;
+    for (std::size_t i=0; i < ops; ++i) {
+        // two pushes out of three, so that the queue keeps growing and spills to disk
+        if (reference.is_empty() || rand() % 3 != 0) {
+            const long long value{rand()};
+            external.push(value);
+            reference.push(value);
+        }
+        else if (external.top() != reference.top() || external.pop() != reference.pop()) {
+            return false;
+        }
+    }
+    while (!reference.is_empty()) {
+        if (external.is_empty() || external.pop() != reference.pop()) {
+            return false;
+        }
+    }
+    return external.is_empty();
+}
+
+/**
+  * Keep 'queue' elements in an ExternalHeap with a buffer of 'capacity' elements through 'ops' pairs of a push and
+  * a pop, like a long event replay, checking the pops against a BinaryHeap. Returns true if every pop returned the
+  * same element and the backing file never outgrew four times the queue plus the buffer
+  */
+bool check_steady(const std::size_t ops, const std::size_t queue, const std::size_t capacity) {
+    ExternalHeap<long long, Less<long long>> external{capacity};
+    BinaryHeap<long long, Less<long long>> reference;
+    long long now{0};
+    for (std::size_t i=0; i < queue; ++i) {
+        const long long value{now + rand() % 100000};
+        external.push(value);
+        reference.push(value);
+    }
+    std::size_t largest{0};
+    for (std::size_t i=0; i < ops; ++i) {
+        now = external.pop();
+        if (now != reference.pop()) {
+            return false;
+        }
+        const long long value{now + rand() % 100000};
+        external.push(value);
+        reference.push(value);
+        largest = external.file_size() > largest ? external.file_size() : largest;
+    }
+    std::cout << "File: " << largest << " bytes ";
+    return largest <= 4 * (queue + capacity) * sizeof(long long);
+}
+
+int main() {
+    std::cout << "TESTING THE EXTERNAL HEAP AGAINST A BINARYHEAP:" << std::endl;
+    for (std::size_t capacity : {1, 10, 1000, 100000}) {
+        std::cout << "Buffer: " << capacity << " " << (check(1000000, capacity) ? "correct" : "WRONG") << std::endl;
+    }
+    std::cout << "TESTING THE FILE SIZE UNDER INTERLEAVED PUSH AND POP:" << std::endl;
+    for (std::size_t capacity : {1, 1000, 100000}) {
+        std::cout << "Buffer: " << capacity << " Queue: 150000 ";
+        std::cout << (check_steady(2000000, 150000, capacity) ? "correct" : "WRONG") << std::endl;
+    }
+
+    // the following block of code pushes 'dim' timestamps, mostly increasing like in an event replay, with an
+    // in-memory buffer of one million elements, and then pops them all. Timings are taken in nanoseconds per element
+    std::cout << "TESTING PUSH AND POP ON DISK:" << std::endl;
+    for (std::size_t dim : {1000000, 10000000, 50000000}) {
+        ExternalHeap<long long, Less<long long>> h{1000000};
+        auto start = std::chrono::high_resolution_clock::now();
+        for (std::size_t i=0; i < dim; ++i) {
+            h.push(static_cast<long long>(i) * 16 + rand() % 1000);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "Size: " << dim << " Push: "
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / dim;
+        start = std::chrono::high_resolution_clock::now();
+        while (!h.is_empty()) {
+            h.pop();
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << " Pop: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / dim << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,227 @@
+#ifndef __EXTERNAL_HEAP__
+#define __EXTERNAL_HEAP__
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "heap.h"
+
+/**
+  * External-memory priority queue, for more elements than fit in RAM. It is templated on the type of the data
+  * to store, which must be trivially copyable since it is written to a file as raw bytes, and the type of
+  * comparison defining the heap propriety.
+  * New elements go to an in-memory BinaryHeap of at most 'buffer_capacity' elements. When the buffer is full,
+  * it is drained in order into a sorted run appended to a memory-mapped file, which grows as needed. The runs
+  * are merged lazily by a second, small BinaryHeap holding the first element still to be read from each run,
+  * so POP only has to compare the root of the buffer with the root of the merge heap. Each run is read
+  * sequentially, which keeps the page cache and the readahead effective. The file is unlinked as soon as it
+  * is created, so it disappears with the queue (or the process).
+  * Popping from a run leaves a dead prefix behind it. As soon as the dead elements outnumber the unread ones
+  * plus the runs still in the merge heap, the unread parts of those runs are slid down to the beginning of the
+  * file and the exhausted runs are dropped, so the file stays within a constant factor of the queue size plus
+  * the buffer even when pushes and pops interleave forever. The compaction costs O(1) amortized per element
+  * written or popped since the previous one.
+  */
+template<class T, class Comp>
+class ExternalHeap {
+    static_assert(std::is_trivially_copyable<T>::value, "elements are written to disk as raw bytes");
+
+    // the first element still to be read from a run
+    struct RunHead {
+        T value;  // the element
+        std::size_t run;  // index of the run it comes from
+    };
+    // orders the run heads like their elements
+    struct CompareHeads {
+        Comp compare;
+        bool operator()(const RunHead& a, const RunHead& b) {
+            return compare(a.value, b.value);
+        }
+    };
+
+    BinaryHeap<T, Comp> buffer;  // in-memory heap of the newest elements
+    std::size_t buffer_capacity;  // maximum number of elements in 'buffer'
+    BinaryHeap<RunHead, CompareHeads> heads;  // merge heap over the runs, one element per non-exhausted run
+    std::size_t* next;  // next[r] is the position in the file of the first element of run r still to be read
+    std::size_t* end;  // end[r] is the position just past the last element of run r
+    std::size_t num_runs;  // number of runs written since the file was last reset
+    std::size_t max_runs;  // length of 'next' and 'end'
+    int fd;  // descriptor of the backing file
+    T* map;  // the file, mapped in memory
+    std::size_t mapped;  // number of elements the mapping has room for
+    std::size_t used;  // number of elements written to the file
+    std::size_t unread;  // number of elements of the file still to be read, the live part of 'used'
+    std::size_t count;  // number of elements in the queue
+    Comp compare;  // comparison operator
+
+    // print the error of a failed system call and abort the program
+    static void fail(const char* what) {
+        std::perror(what);
+        abort();
+    }
+    // make the file, and the mapping, large enough for 'n' elements, doubling their size
+    void grow(const std::size_t n) {
+        if (n <= mapped) {
+            return;
+        }
+        std::size_t new_mapped{mapped == 0 ? buffer_capacity : mapped};
+        while (new_mapped < n) {
+            new_mapped *= 2;
+        }
+        if (ftruncate(fd, new_mapped * sizeof(T)) != 0) {
+            fail("ftruncate");
+        }
+        if (map != nullptr) {
+            munmap(map, mapped * sizeof(T));
+        }
+        void* address{mmap(nullptr, new_mapped * sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+        if (address == MAP_FAILED) {
+            fail("mmap");
+        }
+        map = static_cast<T*>(address);
+        mapped = new_mapped;
+    }
+    // drain the buffer into a new sorted run at the end of the file, and add its head to the merge heap
+    void flush() {
+        if (num_runs == max_runs) {
+            max_runs = (max_runs == 0) ? 16 : 2 * max_runs;
+            std::size_t* new_next{new std::size_t[max_runs]};
+            std::size_t* new_end{new std::size_t[max_runs]};
+            for (std::size_t r=0; r < num_runs; ++r) {
+                new_next[r] = next[r];
+                new_end[r] = end[r];
+            }
+            delete[] next;
+            delete[] end;
+            next = new_next;
+            end = new_end;
+        }
+        grow(used + buffer.size);
+        next[num_runs] = used;
+        while (!buffer.is_empty()) {
+            map[used++] = buffer.pop();
+        }
+        end[num_runs] = used;
+        heads.push(RunHead{map[next[num_runs]], num_runs});
+        unread += end[num_runs] - next[num_runs] - 1;
+        ++next[num_runs];
+        ++num_runs;
+    }
+    // slide the unread elements of the runs still in the merge heap down to the beginning of the file, in
+    // file order so that no element is overwritten before being moved, and renumber those runs
+    void compact() {
+        const std::size_t live{heads.size};
+        RunHead* live_heads{new RunHead[live]};
+        bool* alive{new bool[num_runs]};
+        for (std::size_t r=0; r < num_runs; ++r) {
+            alive[r] = false;
+        }
+        for (std::size_t i=0; i < live; ++i) {
+            live_heads[i] = heads.pop();
+            alive[live_heads[i].run] = true;
+        }
+        std::size_t* renumber{new std::size_t[num_runs]};
+        std::size_t runs{0};
+        used = 0;
+        for (std::size_t r=0; r < num_runs; ++r) {
+            if (!alive[r]) {
+                continue;
+            }
+            const std::size_t length{end[r] - next[r]};
+            std::memmove(map + used, map + next[r], length * sizeof(T));
+            next[runs] = used;
+            end[runs] = used + length;
+            used += length;
+            renumber[r] = runs++;
+        }
+        num_runs = runs;
+        for (std::size_t i=0; i < live; ++i) {
+            heads.push(RunHead{live_heads[i].value, renumber[live_heads[i].run]});
+        }
+        delete[] renumber;
+        delete[] alive;
+        delete[] live_heads;
+    }
+
+  public:
+    // Constructor, builds an empty queue keeping at most 'capacity' elements in memory, with the backing
+    // file created in 'directory'
+    explicit ExternalHeap(const std::size_t capacity, const char* directory="/tmp") :
+        buffer{}, buffer_capacity{capacity > 0 ? capacity : 1}, heads{}, next{nullptr}, end{nullptr}, num_runs{0},
+        max_runs{0}, fd{-1}, map{nullptr}, mapped{0}, used{0}, unread{0}, count{0}, compare{} {
+        char name[4096];
+        std::snprintf(name, sizeof(name), "%s/external_heap_XXXXXX", directory);
+        fd = mkstemp(name);
+        if (fd == -1) {
+            fail("mkstemp");
+        }
+        unlink(name);
+        buffer.reserve(buffer_capacity);
+    }
+    ExternalHeap(const ExternalHeap&) = delete;
+    ExternalHeap& operator=(const ExternalHeap&) = delete;
+    bool is_empty() const noexcept {
+        return count == 0;
+    }
+    // number of elements in the queue, both in memory and on disk
+    std::size_t size() const noexcept {
+        return count;
+    }
+    // size of the backing file, in bytes
+    std::size_t file_size() const noexcept {
+        return mapped * sizeof(T);
+    }
+    // INSERT procedure, amortized O(log M) comparisons plus one sequential write per element,
+    // where M is the capacity of the buffer
+    void push(const T& value) {
+        if (buffer.size == buffer_capacity) {
+            flush();
+        }
+        buffer.push(value);
+        ++count;
+    }
+    // returns the minimum, or whatever optimum, without removing it
+    const T& top() noexcept {
+        if (heads.is_empty() || (!buffer.is_empty() && !compare(heads.top().value, buffer.top()))) {
+            return buffer.top();
+        }
+        return heads.top().value;
+    }
+    // removes the minimum, or whatever optimum, and returns it, just like EXTRACT_MIN
+    T pop() {
+        --count;
+        if (heads.is_empty() || (!buffer.is_empty() && !compare(heads.top().value, buffer.top()))) {
+            return buffer.pop();
+        }
+        // the optimum is the head of a run: replace it with the following element of the same run
+        RunHead head{heads.pop()};
+        const std::size_t r{head.run};
+        if (next[r] < end[r]) {
+            heads.push(RunHead{map[next[r]], r});
+            ++next[r];
+            --unread;
+        }
+        // reclaim the dead elements once they outnumber the unread ones plus the live runs, which bounds the
+        // cost of the compaction; when all the runs have been consumed, this just starts the file over
+        if (used > unread && used - unread >= unread + heads.size) {
+            compact();
+        }
+        return head.value;
+    }
+    // Destructor
+    ~ExternalHeap() {
+        if (map != nullptr) {
+            munmap(map, mapped * sizeof(T));
+        }
+        close(fd);
+        delete[] next;
+        delete[] end;
+    }
+};
+
+#endif // __EXTERNAL_HEAP__
@@ -0,0 +1,221 @@
+#ifndef __FIBONACCI_HEAP__
+#define __FIBONACCI_HEAP__
+
+#include <iostream>
+#include <cstdlib>
+
+/**
+  * Fibonacci heap, templated on the type of the data to store, the type of comparison defining the heap
+  * propriety and the 'Handle' function object mapping each element to an integer in [0, n) (see heap.h).
+  * It exposes the same interface as the addressable BinaryHeap (is_empty, extract_min returning a handle,
+  * decrease taking a handle), so it can be plugged into Dijkstra's algorithm as the queue.
+  * The heap is a forest of trees whose roots are kept in a circular doubly-linked list. DECREASE_KEY cuts the
+  * node (and, by cascading cuts, its marked ancestors) into the root list in O(1) amortized time, while
+  * EXTRACT_MIN consolidates the roots by degree in O(log n) amortized time. With Dijkstra's algorithm this
+  * gives the O(m + n log n) bound. The nodes live in an array indexed by handle, so no allocation happens
+  * after the constructor.
+  */
+template<class T, class Comp, class Handle>
+class FibonacciHeap {
+    struct Node {
+        T value;  // the element
+        Node* parent;  // parent, nullptr for the roots
+        Node* child;  // any of the children
+        Node* left;  // left sibling in the circular list
+        Node* right;  // right sibling in the circular list
+        std::size_t degree;  // number of children
+        bool mark;  // whether the node lost a child since it last became a child itself
+    };
+
+    Node* nodes;  // one node per handle
+    Node* min;  // root holding the minimum, nullptr if the heap is empty
+    Node** by_degree;  // scratch array for the consolidation, indexed by degree
+    std::size_t max_degree;  // length of 'by_degree'
+    std::size_t size;  // number of elements still in the heap
+    Comp compare;  // comparison operator
+    Handle handle;  // function object computing the handle of an element
+
+    // splices the single node 'x' into the circular list right after 'list'
+    static void splice(Node* list, Node* x) noexcept {
+        x->left = list;
+        x->right = list->right;
+        list->right->left = x;
+        list->right = x;
+    }
+    // removes 'x' from its circular list, leaving it as a singleton list
+    static void unlink(Node* x) noexcept {
+        x->left->right = x->right;
+        x->right->left = x->left;
+        x->left = x;
+        x->right = x;
+    }
+    // adds the singleton 'x' to the root list, updating the minimum
+    void add_root(Node* x) noexcept {
+        x->parent = nullptr;
+        x->mark = false;
+        if (min == nullptr) {
+            min = x;
+        }
+        else {
+            splice(min, x);
+            if (compare(x->value, min->value)) {
+                min = x;
+            }
+        }
+    }
+    // makes the root 'y' a child of the root 'x'
+    void link(Node* y, Node* x) noexcept {
+        unlink(y);
+        y->parent = x;
+        y->mark = false;
+        if (x->child == nullptr) {
+            x->child = y;
+        }
+        else {
+            splice(x->child, y);
+        }
+        ++x->degree;
+    }
+    // moves 'x' from the children of 'p' to the root list
+    void cut(Node* x, Node* p) noexcept {
+        if (p->child == x) {
+            p->child = (x->right == x) ? nullptr : x->right;
+        }
+        unlink(x);
+        --p->degree;
+        add_root(x);
+    }
+    // cuts the marked ancestors of 'y', and marks the first unmarked one
+    void cascading_cut(Node* y) noexcept {
+        Node* p{y->parent};
+        while (p != nullptr) {
+            if (!y->mark) {
+                y->mark = true;
+                return;
+            }
+            cut(y, p);
+            y = p;
+            p = y->parent;
+        }
+    }
+    // links roots of equal degree until all degrees are distinct, then finds the new minimum
+    void consolidate() noexcept {
+        for (std::size_t i=0; i < max_degree; ++i) {
+            by_degree[i] = nullptr;
+        }
+        // detach the root list first, since linking modifies it
+        Node* w{min};
+        w->left->right = nullptr;
+        while (w != nullptr) {
+            Node* next{w->right};
+            Node* x{w};
+            x->left = x;
+            x->right = x;
+            std::size_t d{x->degree};
+            while (by_degree[d] != nullptr) {
+                Node* y{by_degree[d]};
+                if (compare(y->value, x->value)) {
+                    Node* temp{x};
+                    x = y;
+                    y = temp;
+                }
+                // y is a singleton, so unlinking it inside 'link' is harmless
+                link(y, x);
+                by_degree[d] = nullptr;
+                ++d;
+            }
+            by_degree[d] = x;
+            w = next;
+        }
+        // rebuild the root list from the array
+        min = nullptr;
+        for (std::size_t i=0; i < max_degree; ++i) {
+            if (by_degree[i] != nullptr) {
+                add_root(by_degree[i]);
+            }
+        }
+    }
+
+  public:
+    // constructor, puts the 'n' elements of 'array' in the root list, which is O(n); the first EXTRACT_MIN pays the consolidation
+    FibonacciHeap(const T* array, const std::size_t n) : nodes{new Node[n]}, min{nullptr}, by_degree{nullptr}, max_degree{2}, size{n}, compare{}, handle{} {
+        // the degree of a node of a Fibonacci heap with n elements is at most log_phi(n) < 1.45 * log2(n)
+        for (std::size_t m=n; m > 0; m /= 2) {
+            max_degree += 2;
+        }
+        by_degree = new Node*[max_degree];
+        for (std::size_t i=0; i < n; ++i) {
+            Node* x{&nodes[handle(array[i])]};
+            x->value = array[i];
+            x->child = nullptr;
+            x->left = x;
+            x->right = x;
+            x->degree = 0;
+            add_root(x);
+        }
+    }
+    FibonacciHeap(const FibonacciHeap&) = delete;
+    FibonacciHeap& operator=(const FibonacciHeap&) = delete;
+    bool is_empty() const noexcept {
+        return size == 0;
+    }
+    // removes the minimum, or whatever optimum, and returns its handle
+    std::size_t extract_min() noexcept {
+        Node* z{min};
+        // move the children of z to the root list
+        Node* c{z->child};
+        if (c != nullptr) {
+            Node* last{c->left};
+            for (Node* x=c; ; x = x->right) {
+                x->parent = nullptr;
+                x->mark = false;
+                if (x == last) break;
+            }
+            // concatenate the two circular lists
+            Node* after{z->right};
+            z->right = c;
+            c->left = z;
+            last->right = after;
+            after->left = last;
+            z->child = nullptr;
+        }
+        // remove z from the root list
+        --size;
+        if (z->right == z) {
+            min = nullptr;
+        }
+        else {
+            min = z->right;
+            unlink(z);
+            consolidate();
+        }
+        z->degree = 0;
+        return z - nodes;
+    }
+    // decreases the element with handle 'h' to 'value', which must have the same handle
+    void decrease(const std::size_t h, const T& value) {
+        Node* x{&nodes[h]};
+        // if the value does not imply a decrease, abort the program
+        if (compare(x->value, value)) {
+            std::cout << "value is not smaller than H[i]" << std::endl;
+            abort();
+        }
+        x->value = value;
+        Node* p{x->parent};
+        // if the heap propriety with the parent breaks, move x to the root list
+        if (p != nullptr && compare(x->value, p->value)) {
+            cut(x, p);
+            cascading_cut(p);
+        }
+        else if (p == nullptr && compare(x->value, min->value)) {
+            min = x;
+        }
+    }
+    // destructor
+    ~FibonacciHeap() {
+        delete[] by_degree;
+        delete[] nodes;
+    }
+};
+
+#endif // __FIBONACCI_HEAP__
@@ -1,55 +1,416 @@
 #include <iostream>
 #include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
 
 #include "heap.h"
-// maximum value for the heap elements
-#define MAX_VALUE 25
+
+// default command line parameters
+#define DEFAULT_MAX_SIZE 1000000  // largest heap of the default run; sizes grow by 10 from 1000
+#define DEFAULT_TRIALS 5  // timed trials per measure, after one warm-up
+#define MIN_OPS (1 << 20)  // a trial repeats the workload until it has done at least this many operations
+#define MAX_TRIALS 1000
+#define KEY_RANGE (1 << 30)  // keys are drawn in [0, KEY_RANGE), so that decreased keys never overflow
+
+/**
+  * Fast random number generator (xorshift), so that drawing random operations costs far less than
+  * the operations themselves
+  */
+struct XorShift {
+    std::size_t state;
+    explicit XorShift(const std::size_t seed) : state{seed | 1} {}
+    std::size_t next() noexcept {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+/**
+  * Element of the addressable heaps used for DECREASE_KEY: a key and the identifier used as its handle
+  */
+struct Item {
+    int key;
+    std::size_t id;
+};
+struct CompareKeys {
+    bool operator()(const Item& a, const Item& b) const noexcept {
+        return a.key < b.key;
+    }
+};
+struct ItemHandle {
+    std::size_t operator()(const Item& x) const noexcept {
+        return x.id;
+    }
+};
 
 /**
-  * Function object to play the role of 'std::greater' of the STL.
-  * To be used to create a max-heap
+  * Comparison of ints that the heap cannot see through, since KeyOrder is not specialized for it: wide heaps
+  * using it select the best child with the scalar loop, and serve as the baseline of the SIMD kernels
   */
 template<class T>
-struct CompareItems {
-    // default constructor
-    CompareItems() = default;
-    // overload of operator(); returns true if a > b, false otherwise
-    bool operator()(const T a, const T b) {
-        return a > b;
+struct OpaqueLess {
+    bool operator()(const T& a, const T& b) const noexcept {
+        return a < b;
     }
 };
 
-int main() {
+/**
+  * Operation counters of a run, filled only by instrumented heaps (see HeapStats in heap.h)
+  */
+struct Counts {
+    std::size_t comparisons;
+    std::size_t moves;
+    std::size_t sifts;
+    std::size_t levels;
+    std::size_t pop_paths[HeapStats::PATHS];
+    std::size_t decrease_paths[HeapStats::PATHS];
+
+    Counts() : comparisons{0}, moves{0}, sifts{0}, levels{0}, pop_paths{}, decrease_paths{} {}
+};
+void collect(const NoStats&, Counts&) noexcept {}
+void collect(const HeapStats& stats, Counts& counts) noexcept {
+    counts.comparisons += stats.comparisons;
+    counts.moves += stats.moves;
+    counts.sifts += stats.sifts;
+    counts.levels += stats.levels;
+    for (std::size_t l=0; l < HeapStats::PATHS; ++l) {
+        counts.pop_paths[l] += stats.pop_paths[l];
+        counts.decrease_paths[l] += stats.decrease_paths[l];
+    }
+}
+
+/**
+  * Distributions of the keys. Sorted and reversed inputs are the best and worst cases of PUSH in a min-heap,
+  * few unique keys stress the ties, and Zipf keys (with exponent 1 over 65536 distinct values, the smallest
+  * being the most frequent) mimic the skewed priorities of real workloads
+  */
+enum Distribution {UNIFORM, SORTED, REVERSED, FEW_UNIQUE, ZIPF, NUM_DISTRIBUTIONS};
+const char* distribution_names[NUM_DISTRIBUTIONS] = {"uniform", "sorted", "reversed", "few_unique", "zipf"};
+
+void generate(int* keys, const std::size_t n, const Distribution distribution, XorShift& random) {
+    const double step{static_cast<double>(KEY_RANGE) / n};
+    switch (distribution) {
+        case UNIFORM:
+            for (std::size_t i=0; i < n; ++i) {
+                keys[i] = random.next() % KEY_RANGE;
+            }
+            break;
+        case SORTED:
+            for (std::size_t i=0; i < n; ++i) {
+                keys[i] = static_cast<int>(i * step);
+            }
+            break;
+        case REVERSED:
+            for (std::size_t i=0; i < n; ++i) {
+                keys[i] = static_cast<int>((n - 1 - i) * step);
+            }
+            break;
+        case FEW_UNIQUE:
+            for (std::size_t i=0; i < n; ++i) {
+                keys[i] = (random.next() % 16) * (KEY_RANGE / 16);
+            }
+            break;
+        default: {
+            // cumulative distribution of the ranks, sampled by binary search
+            const std::size_t m{1 << 16};
+            double* cdf = new double[m];
+            double sum{0};
+            for (std::size_t r=0; r < m; ++r) {
+                sum += 1.0 / (r + 1);
+                cdf[r] = sum;
+            }
+            for (std::size_t i=0; i < n; ++i) {
+                const double u{(random.next() >> 11) * (sum / 9007199254740992.0)};  // uniform in [0, sum)
+                std::size_t lo{0};
+                std::size_t hi{m - 1};
+                while (lo < hi) {
+                    const std::size_t mid{(lo + hi) / 2};
+                    if (cdf[mid] <= u) lo = mid + 1;
+                    else hi = mid;
+                }
+                keys[i] = lo * (KEY_RANGE / m);
+            }
+            delete[] cdf;
+        }
+    }
+}
+
+/**
+  * Workloads. Each one runs once on a heap of type 'H' over the 'n' keys of 'keys', returns the time taken by
+  * its n operations in nanoseconds, excluding the setup, and adds the counters of the heap to 'counts'
+  */
+// BUILD_HEAP on the whole input, with 'threads' threads
+template<class H>
+long long build_workload(int* keys, const std::size_t n, const std::size_t threads, Counts& counts) {
+    auto start = std::chrono::high_resolution_clock::now();
+    H h{keys, n, false, threads};
+    auto end = std::chrono::high_resolution_clock::now();
+    collect(h.stats, counts);
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+// PUSH of the whole input into an empty heap, growth included
+template<class H>
+long long push_workload(int* keys, const std::size_t n, Counts& counts) {
+    H h;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (std::size_t i=0; i < n; ++i) {
+        h.push(keys[i]);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    collect(h.stats, counts);
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+// POP until a heap built on the input is empty
+template<class H>
+long long pop_workload(int* keys, const std::size_t n, Counts& counts) {
+    H h{keys, n};
+    h.stats.reset();
+    auto start = std::chrono::high_resolution_clock::now();
+    while (!h.is_empty()) {
+        h.pop();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    collect(h.stats, counts);
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+// DECREASE_KEY of n random elements of an addressable heap built on the input, each to a random key below
+// its current one, as when Dijkstra's algorithm finds a shorter path
+template<class A>
+long long decrease_workload(int* keys, const std::size_t n, XorShift& random, Counts& counts) {
+    Item* items = new Item[n];
+    for (std::size_t i=0; i < n; ++i) {
+        items[i] = Item{keys[i], i};
+    }
+    long long ns;
+    {
+        A h{items, n};
+        h.stats.reset();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (std::size_t i=0; i < n; ++i) {
+            const std::size_t r{random.next()};
+            Item& x = items[r % n];
+            x.key = (x.key > 0) ? static_cast<int>((r >> 32) % x.key) : x.key - 1;
+            h.decrease(x.id, x);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        collect(h.stats, counts);
+        ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+    delete[] items;
+    return ns;
+}
+// n random operations on a heap built on half the input: PUSH of the next key of the input, or POP,
+// with the same probability
+template<class H>
+long long mixed_workload(int* keys, const std::size_t n, XorShift& random, Counts& counts) {
+    H h{keys, n / 2};
+    h.stats.reset();
+    std::size_t next{n / 2};
+    auto start = std::chrono::high_resolution_clock::now();
+    for (std::size_t i=0; i < n; ++i) {
+        if ((random.next() & 1) || h.is_empty()) {
+            h.push(keys[next]);
+            next = (next + 1 < n) ? next + 1 : 0;
+        }
+        else {
+            h.pop();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    collect(h.stats, counts);
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+/**
+  * Writer of the results, one row per measure, either as CSV or as a JSON array of objects. Besides the timings,
+  * a row has the counters of an instrumented run per operation, the mean number of levels covered by a sift,
+  * and the histograms of the path lengths of POP and DECREASE_KEY, as 'levels:count' pairs separated by spaces
+  * in CSV and as objects in JSON
+  */
+struct Report {
+    bool json;  // whether to write JSON rather than CSV
+    bool first;  // whether no row has been written yet
+
+    explicit Report(const bool as_json) : json{as_json}, first{true} {
+        if (json) std::cout << "[" << std::endl;
+        else std::cout << "heap,workload,distribution,size,trials,median_ns_per_op,p99_ns_per_op,comparisons_per_op,moves_per_op,"
+                       << "sifts_per_op,levels_per_sift,pop_paths,decrease_paths" << std::endl;
+    }
+    // write the non-empty buckets of 'histogram'
+    void histogram(const std::size_t* paths) const {
+        bool empty{true};
+        std::cout << (json ? "{" : "");
+        for (std::size_t l=0; l < HeapStats::PATHS; ++l) {
+            if (paths[l] > 0) {
+                if (json) std::cout << (empty ? "" : ", ") << "\"" << l << "\": " << paths[l];
+                else std::cout << (empty ? "" : " ") << l << ":" << paths[l];
+                empty = false;
+            }
+        }
+        std::cout << (json ? "}" : "");
+    }
+    void row(const char* heap, const char* workload, const char* distribution, const std::size_t size, const std::size_t trials,
+             const double median, const double p99, const Counts& counts) {
+        const double comparisons{static_cast<double>(counts.comparisons) / size};
+        const double moves{static_cast<double>(counts.moves) / size};
+        const double sifts{static_cast<double>(counts.sifts) / size};
+        const double levels{counts.sifts > 0 ? static_cast<double>(counts.levels) / counts.sifts : 0};
+        if (json) {
+            std::cout << (first ? "" : ",\n") << "  {\"heap\": \"" << heap << "\", \"workload\": \"" << workload
+                      << "\", \"distribution\": \"" << distribution << "\", \"size\": " << size << ", \"trials\": " << trials
+                      << ", \"median_ns_per_op\": " << median << ", \"p99_ns_per_op\": " << p99
+                      << ", \"comparisons_per_op\": " << comparisons << ", \"moves_per_op\": " << moves
+                      << ", \"sifts_per_op\": " << sifts << ", \"levels_per_sift\": " << levels << ", \"pop_paths\": ";
+            histogram(counts.pop_paths);
+            std::cout << ", \"decrease_paths\": ";
+            histogram(counts.decrease_paths);
+            std::cout << "}";
+        }
+        else {
+            std::cout << heap << "," << workload << "," << distribution << "," << size << "," << trials << ","
+                      << median << "," << p99 << "," << comparisons << "," << moves << "," << sifts << "," << levels << ",";
+            histogram(counts.pop_paths);
+            std::cout << ",";
+            histogram(counts.decrease_paths);
+            std::cout << std::endl;
+        }
+        first = false;
+    }
+    ~Report() {
+        if (json) std::cout << (first ? "" : "\n") << "]" << std::endl;
+    }
+};
+
+/**
+  * Measure a workload on 'n' keys. 'run' and 'counted' run it once on the heap being measured and on its
+  * instrumented twin, respectively. A trial repeats 'run' until at least MIN_OPS operations have been done,
+  * so that small heaps are not timed below the resolution of the clock. After one warm-up trial, 'trials'
+  * trials are timed; the row reports the median and the 99th percentile of their nanoseconds per operation
+  * (with few trials the latter is the slowest trial), and the counters of one instrumented run
+  */
+template<class Run, class Counted>
+void measure(Report& report, const char* heap, const char* workload, const char* distribution, const std::size_t n,
+             const std::size_t trials, Run run, Counted counted) {
+    const std::size_t reps{(MIN_OPS + n - 1) / n};
+    double ns_per_op[MAX_TRIALS];
+    Counts counts;
+    for (std::size_t t=0; t <= trials; ++t) {
+        long long ns{0};
+        for (std::size_t r=0; r < reps; ++r) {
+            ns += run(counts);
+        }
+        // the first trial is the warm-up
+        if (t > 0) {
+            ns_per_op[t-1] = static_cast<double>(ns) / (reps * n);
+        }
+    }
+    // insertion sort of the trials
+    for (std::size_t i=1; i < trials; ++i) {
+        const double x{ns_per_op[i]};
+        std::size_t j{i};
+        for (; j > 0 && ns_per_op[j-1] > x; --j) {
+            ns_per_op[j] = ns_per_op[j-1];
+        }
+        ns_per_op[j] = x;
+    }
+    counts = Counts{};
+    counted(counts);
+    report.row(heap, workload, distribution, n, trials, ns_per_op[trials / 2], ns_per_op[(99 * trials + 99) / 100 - 1], counts);
+}
+
+/**
+  * Layout of a heap of arity 'D' with elements of type 'T': the implicit one if 'Bytes' is 0, else the blocked
+  * one with blocks of 'Bytes' bytes
+  */
+template<class T, std::size_t D, std::size_t Bytes>
+struct LayoutOf {
+    typedef BlockedLayout<T, Bytes> type;
+};
+template<class T, std::size_t D>
+struct LayoutOf<T, D, 0> {
+    typedef ImplicitLayout<D> type;
+};
+
+/**
+  * Run all the workloads on the heap variant of arity 'D', layout given by 'Bytes' (see LayoutOf) and comparison
+  * 'Comp' of the int keys, over the 'n' keys of 'keys', drawn from 'distribution'
+  */
+template<std::size_t D, std::size_t Bytes, class Comp=Less<int>>
+void benchmark_variant(Report& report, const char* heap, int* keys, const std::size_t n, const char* distribution,
+                       const std::size_t trials) {
+    typedef DaryHeap<int, Comp, D, NoHandle, typename LayoutOf<int, D, Bytes>::type> H;
+    typedef DaryHeap<int, Comp, D, NoHandle, typename LayoutOf<int, D, Bytes>::type, HeapStats> HS;
+    typedef DaryHeap<Item, CompareKeys, D, ItemHandle, typename LayoutOf<Item, D, Bytes>::type> A;
+    typedef DaryHeap<Item, CompareKeys, D, ItemHandle, typename LayoutOf<Item, D, Bytes>::type, HeapStats> AS;
+    XorShift random{n};
+    measure(report, heap, "build", distribution, n, trials,
+            [&](Counts& c) {return build_workload<H>(keys, n, 1, c);},
+            [&](Counts& c) {build_workload<HS>(keys, n, 1, c);});
+    const std::size_t threads{std::thread::hardware_concurrency()};
+    if (threads > 1) {
+        measure(report, heap, "parallel_build", distribution, n, trials,
+                [&](Counts& c) {return build_workload<H>(keys, n, threads, c);},
+                [&](Counts& c) {build_workload<HS>(keys, n, threads, c);});
+    }
+    measure(report, heap, "push", distribution, n, trials,
+            [&](Counts& c) {return push_workload<H>(keys, n, c);},
+            [&](Counts& c) {push_workload<HS>(keys, n, c);});
+    measure(report, heap, "pop", distribution, n, trials,
+            [&](Counts& c) {return pop_workload<H>(keys, n, c);},
+            [&](Counts& c) {pop_workload<HS>(keys, n, c);});
+    // the addressable heaps hold Items, whose best child is always found by the scalar loop: with another 'Comp',
+    // the row would only repeat the one of the variant with Less<int>
+    if (std::is_same<Comp, Less<int>>::value) {
+        measure(report, heap, "decrease", distribution, n, trials,
+                [&](Counts& c) {return decrease_workload<A>(keys, n, random, c);},
+                [&](Counts& c) {decrease_workload<AS>(keys, n, random, c);});
+    }
+    measure(report, heap, "mixed", distribution, n, trials,
+            [&](Counts& c) {return mixed_workload<H>(keys, n, random, c);},
+            [&](Counts& c) {mixed_workload<HS>(keys, n, random, c);});
+}
+
+/**
+  * Benchmark of the heap variants. Usage:
+  *     ./heap_test.x [csv|json] [max_size] [trials]
+  * Sizes go from 1000 up to 'max_size' (1000000 by default), multiplying by 10; sizes up to 10^9 can be
+  * requested, given about 45 bytes of memory per element (for DECREASE_KEY). The results are written to the standard output
+  */
+int main(int argc, char* argv[]) {
     // in the following, tests will be made using the functionalities of the
     // <chrono> header. I am aware that this is a break of the no-STL rule,
     // but the clock used by C++ is the highest-resolution clock in the world,
     // and the functions of the <time.h> header provided sometime bogus results
+    const bool json{argc > 1 && std::strcmp(argv[1], "json") == 0};
+    if (argc > 1 && !json && std::strcmp(argv[1], "csv") != 0) {
+        std::cerr << "usage: " << argv[0] << " [csv|json] [max_size] [trials]" << std::endl;
+        return 1;
+    }
+    const std::size_t max_size{argc > 2 ? std::strtoull(argv[2], nullptr, 10) : DEFAULT_MAX_SIZE};
+    std::size_t trials{argc > 3 ? std::strtoull(argv[3], nullptr, 10) : DEFAULT_TRIALS};
+    trials = (trials < 1) ? 1 : (trials > MAX_TRIALS ? MAX_TRIALS : trials);
 
-    std::cout << "TESTING THE IMPLEMENTATION OF HEAPIFY:" << std::endl;
-    // random seed
-    srand(0);
-    // loop over the set of dimensions to investigate
-    for (std::size_t dim : {1000, 5000, 10000, 50000, 100000, 500000, 1000000}) {
-        int test[dim];
-        // initialize array of random values
-        for (std::size_t i=0; i < dim; ++i) {
-            test[i] = rand()%(2*MAX_VALUE)-MAX_VALUE;
-        }
-        { //new scope to make sure the destructor of BinaryHeap gets called before the next iteration,
-          // to avoid subtle memory leaks
-            // build a max-heap of int, having elements in 'test' and dimensions 'dim'
-            BinaryHeap<int, CompareItems<int>> h{test, dim};
-            h[0] = 0.0;    // break heap property, so that a call to heapify on the root makes sense
-            // measure time
-            //double start = seconds();
-            auto start = std::chrono::high_resolution_clock::now();
-            h.heapify(0);
-            auto end = std::chrono::high_resolution_clock::now();
-            //double end = seconds();
-            // print result
-            std::cout << "Size: " << dim << std::endl;
-            std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << std::endl;
+    Report report{json};
+    XorShift random{0};
+    for (std::size_t n=1000; n <= max_size; n *= 10) {
+        int* keys = new int[n];
+        for (std::size_t d=0; d < NUM_DISTRIBUTIONS; ++d) {
+            generate(keys, n, static_cast<Distribution>(d), random);
+            benchmark_variant<2, 0>(report, "binary", keys, n, distribution_names[d], trials);
+            benchmark_variant<4, 0>(report, "4-ary", keys, n, distribution_names[d], trials);
+            benchmark_variant<8, 0>(report, "8-ary", keys, n, distribution_names[d], trials);
+            benchmark_variant<16, 0>(report, "16-ary", keys, n, distribution_names[d], trials);
+            // the wide heaps again, with the scalar selection of the best child instead of the SIMD kernel
+            benchmark_variant<8, 0, OpaqueLess<int>>(report, "8-ary_opaque", keys, n, distribution_names[d], trials);
+            benchmark_variant<16, 0, OpaqueLess<int>>(report, "16-ary_opaque", keys, n, distribution_names[d], trials);
+            benchmark_variant<2, 64>(report, "blocked_64", keys, n, distribution_names[d], trials);
+            benchmark_variant<2, 4096>(report, "blocked_4096", keys, n, distribution_names[d], trials);
         }
+        delete[] keys;
     }
     return 0;
 }
@@ -3,30 +3,293 @@
 
 #include <iostream>
 #include <math.h>
+#include <type_traits>
+#include <thread>
+
+#include "simd_children.h"
 
 // some useful macros to define heap invariants
-#define LEFT(x) 2*x + 1
-#define RIGHT(x) 2*x + 2
-#define PARENT(x) (x - 1) / 2
-#define GET_ROOT() 0
-#define IS_ROOT(x) x == 0
+#define NOT_IN_HEAP static_cast<std::size_t>(-1)  // slot of a handle whose element has been extracted
+#define PARALLEL_BUILD_THRESHOLD (1 << 16)  // below this number of nodes in a level, BUILD_HEAP stays serial
+
+/**
+  * Tag to be passed as the 'Handle' parameter of a heap whose elements never need to be located,
+  * like the one used by heapsort. No position map is kept in that case
+  */
+struct NoHandle {};
+
+/**
+  * Position map of an addressable heap. The 'Handle' function object maps every element to an integer
+  * in [0, n) that identifies it for the whole life of the heap (for example, the index of a vertex);
+  * the map keeps, for each handle, the slot of the heap array currently holding that element. The heap
+  * must call 'place' every time it moves an element, so that DECREASE_KEY finds it in O(1), and 'track'
+  * every time a new element enters the heap, so that the map grows to accommodate its handle
+  */
+template<class T, class Handle>
+struct PositionMap {
+    std::size_t* slot;  // slot[h] is the position in the heap array of the element with handle h
+    std::size_t capacity;  // number of handles the map has room for
+    Handle handle;  // function object computing the handle of an element
+    // allocate room for the handles in [0, n)
+    explicit PositionMap(const std::size_t n) : slot{new std::size_t[n]}, capacity{n}, handle{} {}
+    PositionMap(const PositionMap&) = delete;
+    PositionMap& operator=(const PositionMap&) = delete;
+    // make room for the handle of the new element 'x', doubling the map if needed
+    void track(const T& x) {
+        const std::size_t h{handle(x)};
+        if (h >= capacity) {
+            std::size_t new_capacity{2 * capacity > h ? 2 * capacity : h + 1};
+            std::size_t* new_slot{new std::size_t[new_capacity]};
+            for (std::size_t i=0; i < capacity; ++i) {
+                new_slot[i] = slot[i];
+            }
+            for (std::size_t i=capacity; i < new_capacity; ++i) {
+                new_slot[i] = NOT_IN_HEAP;
+            }
+            delete[] slot;
+            slot = new_slot;
+            capacity = new_capacity;
+        }
+    }
+    // record that 'x' now lives in slot 'i'
+    void place(const T& x, const std::size_t i) noexcept {
+        slot[handle(x)] = i;
+    }
+    // record that 'x' left the heap
+    void remove(const T& x) noexcept {
+        slot[handle(x)] = NOT_IN_HEAP;
+    }
+    // the slot of the element with handle 'h'
+    std::size_t operator[](const std::size_t h) const noexcept {
+        return slot[h];
+    }
+    ~PositionMap() {
+        delete[] slot;
+    }
+};
 
 /**
-  * The Heap class is templated on the type of the data to store and the type of comparison
-  * to define the heap propriety. It implements all the heap algorithms touched in lecture.
+  * Specialization for heaps that are not addressable: every update is a no-op the compiler throws away
+  */
+template<class T>
+struct PositionMap<T, NoHandle> {
+    explicit PositionMap(const std::size_t) {}
+    void track(const T&) noexcept {}
+    void place(const T&, const std::size_t) noexcept {}
+    void remove(const T&) noexcept {}
+};
+
+/**
+  * Function objects to play the role of 'std::less' and 'std::greater' of the STL, to build a min-heap
+  * or a max-heap respectively
+  */
+template<class T>
+struct Less {
+    bool operator()(const T a, const T b) const noexcept {
+        return a < b;
+    }
+};
+template<class T>
+struct Greater {
+    bool operator()(const T a, const T b) const noexcept {
+        return a > b;
+    }
+};
+
+/**
+  * Trait telling whether the comparison 'Comp' orders integer keys by their value (-1 for a min-heap,
+  * 1 for a max-heap) or in some other way (0). A wide heap of int keys whose comparison is known to be
+  * one of the first two picks the best child with the vectorized kernels of simd_children.h;
+  * it can be specialized for other comparison function objects
+  */
+template<class Comp>
+struct KeyOrder {
+    static const int value = 0;
+};
+template<>
+struct KeyOrder<Less<int>> {
+    static const int value = -1;
+};
+template<>
+struct KeyOrder<Greater<int>> {
+    static const int value = 1;
+};
+
+/**
+  * Instrumentation policies of the heap, passed as its 'Stats' parameter. The heap reports every comparison
+  * between elements, every element written to the array and the number of levels covered by every sift
+  * (HEAPIFY, its bottom-up variant and the bubble-up), and, for each EXTRACT_MIN (or POP) and DECREASE_KEY,
+  * the length of the path the element travelled. NoStats, the default, ignores all of them: its functions
+  * are empty and inlined, so an uninstrumented heap compiles to the same code as before.
+  * HeapStats counts them, to tell whether the cost of a heap comes from comparisons or from memory traffic
+  */
+struct NoStats {
+    void reset() noexcept {}
+    void compared(const std::size_t) noexcept {}
+    void moved() noexcept {}
+    void sifted(const std::size_t) noexcept {}
+    void popped(const std::size_t) noexcept {}
+    void decreased(const std::size_t) noexcept {}
+};
+struct HeapStats {
+    static const std::size_t PATHS = 65;  // path lengths of at most 64 levels, which covers any size_t heap
+    std::size_t comparisons;  // comparisons between elements
+    std::size_t moves;  // elements written to the heap array
+    std::size_t sifts;  // number of sifts
+    std::size_t levels;  // levels covered by all the sifts
+    std::size_t pops;  // number of EXTRACT_MIN (or POP)
+    std::size_t decreases;  // number of DECREASE_KEY
+    std::size_t pop_paths[PATHS];  // pop_paths[l] is the number of EXTRACT_MIN whose element moved l levels
+    std::size_t decrease_paths[PATHS];  // decrease_paths[l] is the number of DECREASE_KEY whose element moved l levels
+
+    HeapStats() noexcept {
+        reset();
+    }
+    void reset() noexcept {
+        comparisons = moves = sifts = levels = pops = decreases = 0;
+        for (std::size_t l=0; l < PATHS; ++l) {
+            pop_paths[l] = 0;
+            decrease_paths[l] = 0;
+        }
+    }
+    void compared(const std::size_t k) noexcept {comparisons += k;}
+    void moved() noexcept {++moves;}
+    void sifted(const std::size_t l) noexcept {++sifts; levels += l;}
+    void popped(const std::size_t l) noexcept {++pops; ++pop_paths[l < PATHS ? l : PATHS - 1];}
+    void decreased(const std::size_t l) noexcept {++decreases; ++decrease_paths[l < PATHS ? l : PATHS - 1];}
+    // prints the counters, and the non-empty buckets of the histograms
+    void print(std::ostream& out) const {
+        out << "comparisons: " << comparisons << " moves: " << moves << " sifts: " << sifts << " levels: " << levels << std::endl;
+        out << "extract_min paths (" << pops << "):";
+        for (std::size_t l=0; l < PATHS; ++l) {
+            if (pop_paths[l] > 0) out << " " << l << ":" << pop_paths[l];
+        }
+        out << std::endl << "decrease paths (" << decreases << "):";
+        for (std::size_t l=0; l < PATHS; ++l) {
+            if (decrease_paths[l] > 0) out << " " << l << ":" << decrease_paths[l];
+        }
+        out << std::endl;
+    }
+};
+
+/**
+  * Memory layouts of the heap tree. A layout maps the nodes of the tree to the slots of the heap array: it
+  * gives the slot of the root, of the children and of the parent of a node, and converts between a slot and
+  * the ordinal of its node, i.e. its rank in the order in which the heap is filled, so that the heap of 'size'
+  * elements is made of the nodes of ordinal 0, ..., size - 1. 'storage' gives the length of the array needed to
+  * hold n nodes.
+  * ImplicitLayout is the usual breadth-first layout of the lecture, where slot and ordinal coincide.
+  */
+template<std::size_t D>
+struct ImplicitLayout {
+    static const std::size_t arity = D;
+    static const bool breadth_first = true;  // whether the ancestors of consecutive nodes are consecutive too
+    static constexpr std::size_t root() noexcept {return 0;}
+    static constexpr std::size_t child(const std::size_t i, const std::size_t k) noexcept {return D * i + 1 + k;}
+    static constexpr std::size_t parent(const std::size_t i) noexcept {return (i - 1) / D;}
+    static constexpr std::size_t slot(const std::size_t ordinal) noexcept {return ordinal;}
+    static constexpr std::size_t ordinal(const std::size_t i) noexcept {return i;}
+    static constexpr std::size_t storage(const std::size_t n) noexcept {return n;}
+};
+
+// the largest h >= 2 such that a block of 2^h elements of 'element' bytes fits in 'bytes' bytes
+constexpr std::size_t block_height(const std::size_t bytes, const std::size_t element) noexcept {
+    return bytes >= 8 * element ? 1 + block_height(bytes / 2, element) : 2;
+}
+
+/**
+  * Blocked layout of a binary heap (a B-heap). The tree is cut into subtrees of height H, each stored in its
+  * own block of 2^H slots of the array, chosen so that a block fits in 'Bytes' bytes: a cache line (64) or a
+  * page (4096). Inside a block the subtree is laid out breadth-first from slot 1 (slot 0 is left empty, so that
+  * blocks stay aligned to each other); the 2^H children of the bottom row of a block are the roots of 2^H child
+  * blocks, and the blocks themselves are numbered breadth-first. A path from the root to a leaf then crosses a
+  * new block only every H levels, instead of a new cache line or page at every level below the first few, at
+  * the price of some shifts and masks to find children and parents. The blocks are filled one at a time, so the
+  * array stays dense and a heap of n elements still needs about n slots.
+  */
+template<class T, std::size_t Bytes>
+struct BlockedLayout {
+    static const std::size_t arity = 2;
+    static const bool breadth_first = false;
+    static const std::size_t H = block_height(Bytes, sizeof(T));  // height of the subtree stored in a block
+    static const std::size_t F = std::size_t{1} << H;  // slots per block, and child blocks per block
+    static const std::size_t B = F - 1;  // nodes per block
+    static const std::size_t HALF = F / 2;  // in-block index of the first node of the bottom row
+    static constexpr std::size_t root() noexcept {return 1;}
+    static std::size_t child(const std::size_t i, const std::size_t k) noexcept {
+        const std::size_t block{i >> H};
+        const std::size_t l{i & B};
+        // inside the block, unless i is in its bottom row
+        if (l < HALF) {
+            return (block << H) | (2 * l + k);
+        }
+        return ((block * F + 1 + 2 * (l - HALF) + k) << H) | 1;
+    }
+    static std::size_t parent(const std::size_t i) noexcept {
+        const std::size_t block{i >> H};
+        const std::size_t l{i & B};
+        // inside the block, unless i is the root of its block
+        if (l > 1) {
+            return (block << H) | (l >> 1);
+        }
+        return (((block - 1) / F) << H) | (HALF + (((block - 1) % F) >> 1));
+    }
+    static std::size_t slot(const std::size_t ordinal) noexcept {return ((ordinal / B) << H) | (ordinal % B + 1);}
+    static std::size_t ordinal(const std::size_t i) noexcept {return (i >> H) * B + (i & B) - 1;}
+    static std::size_t storage(const std::size_t n) noexcept {return n == 0 ? 0 : slot(n - 1) + 1;}
+};
+
+template<class T>
+using CacheLineLayout = BlockedLayout<T, 64>;
+template<class T>
+using PageLayout = BlockedLayout<T, 4096>;
+
+/**
+  * The Heap class is templated on the type of the data to store, the type of comparison
+  * to define the heap propriety and the arity 'D' of the tree (the number of children of each node).
+  * It implements all the heap algorithms touched in lecture. Since 'D' is a compile-time constant,
+  * the child and parent indices are computed with constant multiplications and divisions (shifts
+  * when 'D' is a power of two). A wider tree is shallower (log_D(n) levels), so EXTRACT_MIN and
+  * HEAPIFY touch fewer cache lines, at the price of D - 1 comparisons per level instead of one.
+  * The last parameter, 'Handle', makes the heap addressable: EXTRACT_MIN returns the handle of the
+  * minimum and DECREASE_KEY takes the handle of the element to decrease (see PositionMap above).
+  * Unless it has been built in-place on an outer array, the heap owns its storage, which grows by
+  * doubling on PUSH; an in-place heap switches to an owned copy the first time it has to grow.
+  * The 'Layout' policy decides where each node lives in the array (see ImplicitLayout and BlockedLayout
+  * above): all the procedures below work on slots and navigate the tree only through it.
+  * Wide heaps (D = 8 or 16) of int keys in the implicit layout, ordered by Less or Greater, find the best
+  * child with a branch-free vectorized kernel whenever all D children exist (see KeyOrder above).
+  * The 'Stats' policy counts comparisons, moves and sift lengths (see NoStats and HeapStats above).
   * In the 'heap.cc' script is possible to run a test to benchmark the execution time of HEAPIFY,
   * and, as expected, it turns out to be O(logn), where n is the number of nodes of the heap.
   */
-template<class T, class Comp>
-struct BinaryHeap {
+template<class T, class Comp, std::size_t D, class Handle=NoHandle, class Layout=ImplicitLayout<D>, class Stats=NoStats>
+struct DaryHeap {
+    static_assert(D >= 2, "a heap needs at least two children per node");
+    static_assert(Layout::arity == D, "the layout must have the same arity as the heap");
+    // whether the best child is found by the kernels of simd_children.h
+    static const bool simd_children = std::is_same<T, int>::value && Layout::breadth_first
+                                      && (D == 8 || D == 16) && KeyOrder<Comp>::value != 0;
     // data
     std::size_t size;  // size of the heap
+    std::size_t capacity;  // number of elements 'data' has room for (the array has Layout::storage(capacity) slots)
     T* data;  // array of elements
+    bool owned;  // whether 'data' has been allocated by the heap, and must be released by it
     Comp compare;  // comparison operator
+    PositionMap<T, Handle> positions;  // slot of each handle, empty if the heap is not addressable
+    Stats stats;  // operation counters, empty unless the heap is instrumented
+    // default constructor, builds an empty heap to be filled with PUSH
+    DaryHeap() : size{0}, capacity{0}, data{nullptr}, owned{true}, compare{}, positions{0}, stats{} {}
     // constructor (BUILD_HEAP procedure). Notice the call to std::move allows us to implement heapsort in place.
-    // Takes the 'array' to take elements from, its size 'n', and a boolean flag 'inplace'
-    BinaryHeap(T* array, const std::size_t n, const bool inplace=false) : size{n}, data{}, compare{} {
+    // Takes the 'array' to take elements from, its size 'n', a boolean flag 'inplace' and the number of
+    // 'threads' to build the heap with. If the heap is addressable, the handles of the elements must lie in [0, n)
+    DaryHeap(T* array, const std::size_t n, const bool inplace=false, const std::size_t threads=1) : size{n}, capacity{n}, data{}, owned{!inplace}, compare{}, positions{n}, stats{} {
         if (inplace) {
+            // only the breadth-first layout can reuse the outer array as it is
+            if (!Layout::breadth_first) {
+                std::cout << "only the implicit layout can be built in-place" << std::endl;
+                abort();
+            }
             // repositioning the pointer allows us to work with one copy of the same array.
             // Notice that, as a result, any change to the heap array will be reflected on
             // the outer array as well
@@ -34,16 +297,73 @@ struct BinaryHeap {
         }
         // if build is not in-place, allocate an array on the heap and copy elements one by one from 'array'
         else {
-            data = new T[size];
+            data = new T[Layout::storage(size)];
             for (std::size_t i=0; i < size; ++i) {
-                data[i] = array[i];
+                data[Layout::slot(i)] = array[i];
             }
         }
-        // call HEAPIFY bottom-up
-        for (int i=PARENT(size-1); i >= 0; --i) {  // int because the condition is always true for std::size_t
-            heapify(i);
+        for (std::size_t i=0; i < size; ++i) {
+            positions.place(data[Layout::slot(i)], Layout::slot(i));
+        }
+        build(threads);
+    }
+    // call HEAPIFY bottom-up, in reverse order of filling. In the breadth-first layout the nodes past
+    // the parent of the last leaf are all leaves, so the loop can start from there
+    void build() noexcept {
+        if (size > 1) {
+            const std::size_t internal{Layout::breadth_first ? Layout::ordinal(parent(Layout::slot(size-1))) + 1 : size};
+            for (std::size_t i=internal; i > 0; --i) {  // shifted by one because the condition is always true for std::size_t
+                heapify(Layout::slot(i-1));
+            }
         }
     }
+    // parallel BUILD_HEAP. The subtrees rooted at the nodes of one level are disjoint, so HEAPIFY can run on all
+    // of them at the same time; the levels are processed bottom-up, each split in 'threads' chunks of contiguous
+    // nodes, and the threads are joined before moving one level up. The levels with fewer than
+    // PARALLEL_BUILD_THRESHOLD nodes, as well as the whole build outside the breadth-first layout or of an
+    // instrumented heap (whose counters are not shared safely), stay serial
+    void build(const std::size_t threads) {
+        if (threads <= 1 || size <= PARALLEL_BUILD_THRESHOLD || !Layout::breadth_first || !std::is_same<Stats, NoStats>::value) {
+            build();
+            return;
+        }
+        // first node of each level, up to the first one past the internal nodes
+        const std::size_t internal{Layout::ordinal(parent(Layout::slot(size-1))) + 1};
+        std::size_t first[65];
+        std::size_t levels{0};
+        first[0] = 0;
+        for (std::size_t width=1; first[levels] < internal; width *= D) {
+            first[levels + 1] = first[levels] + width;
+            ++levels;
+        }
+        std::thread* workers{new std::thread[threads]};
+        for (std::size_t l=levels; l > 0; --l) {
+            const std::size_t lo{first[l-1]};
+            const std::size_t hi{first[l] < internal ? first[l] : internal};
+            if (hi - lo < PARALLEL_BUILD_THRESHOLD) {
+                heapify_range(lo, hi);
+                continue;
+            }
+            const std::size_t chunk{(hi - lo + threads - 1) / threads};
+            for (std::size_t t=0; t < threads; ++t) {
+                const std::size_t a{lo + t * chunk < hi ? lo + t * chunk : hi};
+                const std::size_t b{a + chunk < hi ? a + chunk : hi};
+                workers[t] = std::thread{[this, a, b]() {heapify_range(a, b);}};
+            }
+            for (std::size_t t=0; t < threads; ++t) {
+                workers[t].join();
+            }
+        }
+        delete[] workers;
+    }
+    // HEAPIFY on the nodes of ordinal lo, ..., hi - 1, from the last one
+    void heapify_range(const std::size_t lo, const std::size_t hi) noexcept {
+        for (std::size_t i=hi; i > lo; --i) {
+            heapify(Layout::slot(i-1));
+        }
+    }
+    DaryHeap(const DaryHeap&) = delete;
+    DaryHeap& operator=(const DaryHeap&) = delete;
     // overload of operator[], returns by reference. Used in Dijkstra's algorithm implementation
     T& operator[](const std::size_t i) noexcept {
         return data[i];
@@ -51,64 +371,211 @@ struct BinaryHeap {
     bool is_empty() const noexcept {
         return size == 0;
     }
-    // HEAP_MINIMUM procedure to remove the minimum, or whatever optimum.
-    // Instrumented for Dijkstra's algorithm
-    int extract_min() noexcept {
-        // extract the root and replace it with the rightmost leaf
-        int ans = data[0].index;
-        data[0] = data[size - 1];
+    // HEAP_MINIMUM procedure, returns the minimum, or whatever optimum, without removing it
+    const T& top() const noexcept {
+        return data[root()];
+    }
+    // make room for at least 'n' elements, so that the following PUSHes do not reallocate
+    void reserve(const std::size_t n) {
+        if (n <= capacity) {
+            return;
+        }
+        T* new_data{new T[Layout::storage(n)]};
+        for (std::size_t i=0; i < Layout::storage(size); ++i) {
+            new_data[i] = data[i];
+        }
+        if (owned) {
+            delete[] data;
+        }
+        data = new_data;
+        capacity = n;
+        owned = true;
+    }
+    // INSERT procedure: append 'value' as the rightmost leaf and bubble it up. O(log n), plus an
+    // amortized O(1) for the growth of the array
+    void push(const T& value) {
+        if (size == capacity) {
+            reserve(capacity == 0 ? 1 : 2 * capacity);
+        }
+        positions.track(value);
+        const std::size_t i{Layout::slot(size)};
+        data[i] = value;
+        positions.place(data[i], i);
+        ++size;
+        bubble_up(i);
+    }
+    // INSERT for a batch of 'k' elements from 'array'. A small batch is bubbled up element by element,
+    // in O(k log n); a batch larger than the height of the tree is appended as a whole and fixed with
+    // HEAPIFY on the ancestors of the new leaves only, level by level up to the root, in O(k + log^2 n)
+    void push_range(const T* array, const std::size_t k) {
+        if (size + k > capacity) {
+            reserve(size + k > 2 * capacity ? size + k : 2 * capacity);
+        }
+        std::size_t height{0};
+        for (std::size_t m=size + k; m > 0; m /= D) {
+            ++height;
+        }
+        // outside the breadth-first layout the ancestors of the new leaves are scattered, so
+        // the batch is always pushed element by element
+        if (k <= height || !Layout::breadth_first) {
+            for (std::size_t i=0; i < k; ++i) {
+                push(array[i]);
+            }
+            return;
+        }
+        const std::size_t old_size{size};
+        for (std::size_t i=0; i < k; ++i) {
+            positions.track(array[i]);
+            data[Layout::slot(size)] = array[i];
+            positions.place(data[Layout::slot(size)], Layout::slot(size));
+            ++size;
+        }
+        if (old_size == 0) {
+            build();
+            return;
+        }
+        // the ancestors of the new leaves at each level form a contiguous range [lo, hi]
+        std::size_t lo{old_size};
+        std::size_t hi{size - 1};
+        while (hi > 0) {
+            lo = parent(lo);
+            hi = parent(hi);
+            for (std::size_t i=hi+1; i > lo; --i) {
+                heapify(i-1);
+            }
+        }
+    }
+    // removes the minimum, or whatever optimum, and returns it
+    T pop() noexcept {
+        T ans{data[root()]};
+        positions.remove(data[root()]);
         // update size and free space
         --size;
-        // call heapify on the root
-        heapify(GET_ROOT());
+        // replace the root with the rightmost leaf, which is now just past the end of the heap
+        // and so is left untouched while the hole moves
+        if (size > 0) {
+            stats.popped(sift_down(root(), data[Layout::slot(size)]));
+        }
+        else {
+            stats.popped(0);
+        }
         return ans;
     }
-    // HEAP_DECREASE_KEY procedure; decrease the element H[i] to 'value'
-    void decrease(std::size_t i, const T& value) {
-        // if the value does not imply a decrease, abort the program
-        if (compare(data[i], value)) {
-            std::cout << "value is not smaller than H[i]" << std::endl;
+    // HEAP_MINIMUM procedure to remove the minimum, or whatever optimum. Returns the handle
+    // of the removed element, so it is available only for addressable heaps
+    std::size_t extract_min() noexcept {
+        static_assert(!std::is_same<Handle, NoHandle>::value, "extract_min needs an addressable heap");
+        std::size_t ans{positions.handle(data[root()])};
+        pop();
+        return ans;
+    }
+    // HEAP_DECREASE_KEY procedure; decrease the element with handle 'h' to 'value', which must have
+    // the same handle. The position map finds the element in O(1), so the whole operation is O(log n)
+    void decrease(const std::size_t h, const T& value) {
+        static_assert(!std::is_same<Handle, NoHandle>::value, "decrease needs an addressable heap");
+        const std::size_t i{positions[h]};
+        // if the element already left the heap, or the value does not imply a decrease, abort the program
+        if (i == NOT_IN_HEAP) {
+            std::cout << "element is not in the heap" << std::endl;
             abort();
         }
-        data[i] = value;
-        // push the problem one level up to the root
-        bubble_up(i);
-    }
-    // Same as above, but using an integer as new value. Necessary for binary heap-based implementation of
-    // Dijkstra's algorithm, since the 'DECREASE' operation applies specifically to the .d member of the
-    // Vertex class
-    void decrease(std::size_t i, const int value) {
-        // if the value does not imply a decrease, abort the program
         if (compare(data[i], value)) {
             std::cout << "value is not smaller than H[i]" << std::endl;
             abort();
         }
-        data[i].d = value;
-        bubble_up(i);
+        data[i] = value;
+        stats.moved();
+        // push the problem one level up to the root
+        stats.decreased(bubble_up(i));
     }
-    // HEAPIFY routine, iterative version
-    void heapify(std::size_t i) noexcept {
-          std::size_t m{i};
-          // iterate as long as the current node doesn't satisfy the heap propriety, else break
+    // HEAPIFY routine, iterative version. Rather than swapping the node with its best child at every
+    // level, it lifts the element out of the tree, leaving a "hole" that moves down as children are
+    // copied up into it, and writes the element once in the slot where the hole stops. Returns the number
+    // of levels the element went down
+    std::size_t heapify(std::size_t i) noexcept {
+          const T x{data[i]};
+          std::size_t levels{0};
+          // iterate as long as the element doesn't satisfy the heap propriety in the hole, else break
           while (true) {
-                // for the left and right children, if it is a valid node and the key is smaller or equal
-                // (borrowing notation from a min-heap) than the current node, let m be equal to it
-                if (is_valid_node(LEFT(i)) && compare(data[LEFT(i)], data[m])) {
-                    m = LEFT(i);
-                }
-                if (is_valid_node(RIGHT(i)) && compare(data[RIGHT(i)], data[m])) {
-                    m = RIGHT(i);
-                }
-                // if i is different from m, then one of the two children breaks the heap propriety
-                // and a swap is necessary to push the problem one level down
-                if (i != m) {
-                    swap(i, m);
+                // if the best child is smaller or equal (borrowing notation from a min-heap) than the
+                // element, it breaks the heap propriety: move it up and push the hole one level down
+                const std::size_t m{best_child(i)};
+                if (m != NOT_IN_HEAP && less(data[m], x)) {
+                    data[i] = data[m];
+                    stats.moved();
+                    positions.place(data[i], i);
                     i = m;
+                    ++levels;
                 }
                 // if such a situation did not occur, by induction the heap propriety must hold heap-wise
                 // and we can stop
                 else break;
-           }
+          }
+          data[i] = x;
+          stats.moved();
+          positions.place(data[i], i);
+          stats.sifted(levels);
+          return levels;
+    }
+    // bottom-up (Wegener) variant of HEAPIFY, filling the hole at node i with the element 'x', which must
+    // not be in the heap. When 'x' is a former leaf, as in EXTRACT_MIN and heapsort, it almost always
+    // belongs near the bottom again: so the hole first goes all the way down to a leaf along the path of
+    // the best children, with D - 1 comparisons per level and none against 'x', and then 'x' climbs back
+    // up from there, usually for just a level or two. Returns the number of levels between node i and the
+    // slot where 'x' ends up
+    std::size_t sift_down(std::size_t i, const T& x) noexcept {
+        const std::size_t top{i};
+        std::size_t levels{0};
+        for (std::size_t m=best_child(i); m != NOT_IN_HEAP; m = best_child(i)) {
+            data[i] = data[m];
+            stats.moved();
+            positions.place(data[i], i);
+            i = m;
+            ++levels;
+        }
+        while (i != top && less(x, data[parent(i)])) {
+            data[i] = data[parent(i)];
+            stats.moved();
+            positions.place(data[i], i);
+            i = parent(i);
+            --levels;
+        }
+        data[i] = x;
+        stats.moved();
+        positions.place(data[i], i);
+        stats.sifted(levels);
+        return levels;
+    }
+    // index of the best child of node i, or NOT_IN_HEAP if i is a leaf
+    std::size_t best_child(const std::size_t i) noexcept {
+        return best_child(i, std::integral_constant<bool, simd_children>());
+    }
+    // vectorized version: a single kernel call when all the D children exist, which are contiguous
+    std::size_t best_child(const std::size_t i, std::true_type) noexcept {
+        const std::size_t first{child(i, 0)};
+        if (first + D <= size) {
+            stats.compared(D - 1);
+            return first + BestOf<(KeyOrder<Comp>::value > 0), D>::find(reinterpret_cast<const int*>(data + first));
+        }
+        return best_child(i, std::false_type());
+    }
+    // scalar version
+    std::size_t best_child(const std::size_t i, std::false_type) noexcept {
+        std::size_t m{child(i, 0)};
+        if (!is_valid_node(m)) {
+            return NOT_IN_HEAP;
+        }
+        // children are filled in order, so the first missing one ends the scan
+        for (std::size_t k=1; k < D; ++k) {
+            const std::size_t c{child(i, k)};
+            if (!is_valid_node(c)) {
+                break;
+            }
+            if (less(data[c], data[m])) {
+                m = c;
+            }
+        }
+        return m;
     }
     // swap helper function
     void swap(const std::size_t i, const std::size_t m) noexcept {
@@ -117,21 +584,63 @@ struct BinaryHeap {
         // this could have been made more efficient using move semantics,
         // but we will stick to the assignment and avoid the STL as much as possible
         data[i] = temp;
+        stats.moved();
+        stats.moved();
+        // keep track of where the two elements went
+        positions.place(data[i], i);
+        positions.place(data[m], m);
     }
     // utility function to check whether an index corresponds to a valid node
-    bool is_valid_node(const std::size_t i) const noexcept {return size-1 >= i;}
-    // bubble-up helper function
-    void bubble_up(std::size_t i) noexcept {
-        // if the node is not the root and violates the heap propriety with respect to
-        // its parent, swap them and move up
-        while (!(IS_ROOT(i)) && compare(data[i], data[PARENT(i)])) {
-            swap(i, PARENT(i));
-            i = PARENT(i);
+    bool is_valid_node(const std::size_t i) const noexcept {return Layout::ordinal(i) < size;}
+    // index of the root
+    static constexpr std::size_t root() noexcept {return Layout::root();}
+    // index of the k-th child (0 <= k < D) of node i
+    static std::size_t child(const std::size_t i, const std::size_t k) noexcept {return Layout::child(i, k);}
+    // index of the parent of node i, which must not be the root
+    static std::size_t parent(const std::size_t i) noexcept {return Layout::parent(i);}
+    // comparison of two elements, counted by the instrumentation policy
+    bool less(const T& a, const T& b) noexcept {
+        stats.compared(1);
+        return compare(a, b);
+    }
+    // bubble-up helper function, moving a hole up like HEAPIFY moves it down. Returns the number of
+    // levels the element went up
+    std::size_t bubble_up(std::size_t i) noexcept {
+        const T x{data[i]};
+        std::size_t levels{0};
+        // if the hole is not the root and the element violates the heap propriety with respect
+        // to its parent, move the parent down into the hole and move up
+        while (i != root() && less(x, data[parent(i)])) {
+            data[i] = data[parent(i)];
+            stats.moved();
+            positions.place(data[i], i);
+            i = parent(i);
+            ++levels;
         }
+        data[i] = x;
+        stats.moved();
+        positions.place(data[i], i);
+        stats.sifted(levels);
+        return levels;
     }
     // destructor
-    ~BinaryHeap() {
+    ~DaryHeap() {
+        if (owned) {
+            delete[] data;
+        }
     }
 };
 
+/**
+  * The binary heap of the lecture is the D = 2 instance of DaryHeap
+  */
+template<class T, class Comp, class Handle=NoHandle, class Stats=NoStats>
+using BinaryHeap = DaryHeap<T, Comp, 2, Handle, ImplicitLayout<2>, Stats>;
+
+/**
+  * Binary heap stored with the blocked layout, with blocks of 'Bytes' bytes
+  */
+template<class T, class Comp, std::size_t Bytes=4096, class Handle=NoHandle, class Stats=NoStats>
+using BlockedHeap = DaryHeap<T, Comp, 2, Handle, BlockedLayout<T, Bytes>, Stats>;
+
 #endif // __HEAP__
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "heap.h"
+#include "kway_merge.h"
+
+/**
+  * Fill 'data' with 'k' sorted runs of 'len' random elements each, described by 'runs'
+  */
+void make_runs(int* data, SortedSpan<int>* runs, const std::size_t k, const std::size_t len) {
+    for (std::size_t r=0; r < k; ++r) {
+        int* run{data + r * len};
+        for (std::size_t i=0; i < len; ++i) {
+            run[i] = rand() % 1000000;
+        }
+        BinaryHeap<int, Greater<int>> h{run, len, true};
+        for (std::size_t i=len; i > 0; --i) {
+            run[i-1] = h.pop();
+        }
+        runs[r] = SortedSpan<int>{run, run + len};
+    }
+}
+
+/**
+  * Merge the 'k' runs with 'Merger', streaming the output through a buffer of 'capacity' elements, and check
+  * that it is sorted and as long as the input. Returns the time taken in milliseconds, or -1 if the output is wrong
+  */
+template<class Merger>
+long long time_merge(const SortedSpan<int>* runs, const std::size_t k, const std::size_t capacity) {
+    std::size_t expected{0};
+    for (std::size_t r=0; r < k; ++r) {
+        expected += runs[r].last - runs[r].first;
+    }
+    int* buffer{new int[capacity]};
+    std::size_t total{0};
+    int previous{-1};
+    bool sorted{true};
+    auto start = std::chrono::high_resolution_clock::now();
+    Merger m{runs, k};
+    while (!m.is_empty()) {
+        const std::size_t written{m.merge(buffer, capacity)};
+        // consume the buffer, as a writer would
+        for (std::size_t i=0; i < written; ++i) {
+            sorted = sorted && previous <= buffer[i];
+            previous = buffer[i];
+        }
+        total += written;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    delete[] buffer;
+    if (!sorted || total != expected) {
+        return -1;
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+}
+
+int main() {
+    std::cout << "TESTING THE K-WAY MERGES ON SMALL INPUTS:" << std::endl;
+    for (std::size_t k : {0, 1, 2, 3, 7, 64, 1000}) {
+        int* data{new int[k * 50 + 1]};
+        SortedSpan<int>* runs{new SortedSpan<int>[k + 1]};
+        make_runs(data, runs, k, 50);
+        // some empty runs, to exercise the exhausted leaves
+        for (std::size_t r=0; r < k; r += 3) {
+            runs[r].last = runs[r].first + r % 2;
+        }
+        const bool correct{time_merge<LoserTree<int, Less<int>>>(runs, k, 7) >= 0 && time_merge<HeapMerge<int, Less<int>>>(runs, k, 7) >= 0};
+        std::cout << "Runs: " << k << " " << (correct ? "correct" : "WRONG") << std::endl;
+        delete[] runs;
+        delete[] data;
+    }
+
+    // the following block of code merges 'k' runs of 10 million elements in total, through an output buffer of
+    // 4096 elements. Timings are taken in milliseconds
+    std::cout << "TESTING THE K-WAY MERGES (10M ELEMENTS):" << std::endl;
+    const std::size_t total{10000000};
+    int* data{new int[total]};
+    for (std::size_t k : {2, 16, 128, 1000}) {
+        SortedSpan<int>* runs{new SortedSpan<int>[k]};
+        make_runs(data, runs, k, total / k);
+        std::cout << "Runs: " << k << " Loser tree: " << time_merge<LoserTree<int, Less<int>>>(runs, k, 4096)
+                  << " Heap: " << time_merge<HeapMerge<int, Less<int>>>(runs, k, 4096) << std::endl;
+        delete[] runs;
+    }
+    delete[] data;
+    return 0;
+}
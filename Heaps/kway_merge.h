@@ -0,0 +1,216 @@
+#ifndef __KWAY_MERGE__
+#define __KWAY_MERGE__
+
+#include "heap.h"
+
+/**
+  * This header file contains two engines merging k sorted runs, with the same interface: built from an array of
+  * k spans, each sorted according to 'Comp', they return the elements of all the runs in order, one at a time
+  * with 'pop' or a buffer at a time with 'merge', so that the output can be streamed (to a file, say) without
+  * ever holding all of it. The spans are only read, and must stay valid while the engine is in use.
+  * 'LoserTree' is the engine of choice. 'HeapMerge' is the fallback built on BinaryHeap.
+  */
+
+/**
+  * A sorted run: the elements from 'first' (included) to 'last' (excluded)
+  */
+template<class T>
+struct SortedSpan {
+    const T* first;
+    const T* last;
+};
+
+/**
+  * Tournament tree of losers. The k runs are the leaves of a complete binary tree, and each internal node keeps
+  * the run that lost the match played there, while the overall winner is kept apart. After the winner's head is
+  * output, only the matches on the path from its leaf to the root have to be replayed, against the losers
+  * stored there: exactly ceil(log k) comparisons per element, with no swaps of elements, just of entries.
+  * Each entry carries a copy of the head of its run, so the replay never dereferences the runs. A run that
+  * is exhausted loses every match.
+  */
+template<class T, class Comp>
+class LoserTree {
+    // a run taking part in the tournament
+    struct Entry {
+        T key;  // copy of the first element of the run still to be output, if any
+        std::size_t run;  // index of the run
+        bool done;  // whether the run is exhausted
+    };
+
+    const T** next;  // next[r] is the element of run r following its head
+    const T** last;  // last[r] is the end of run r
+    Entry* tree;  // tree[1 .. k-1] are the losers of the internal nodes, tree[0] is the winner
+    std::size_t k;  // number of runs, the leaf of run r is node k + r
+    std::size_t count;  // number of elements still to be output
+    Comp compare;  // comparison operator
+
+    // whether 'a' wins the match against 'b'
+    bool beats(const Entry& a, const Entry& b) noexcept {
+        return !a.done && (b.done || compare(a.key, b.key));
+    }
+    // the entry of run 'r' with its next element as the head
+    Entry advance(const std::size_t r) noexcept {
+        if (next[r] == last[r]) {
+            return Entry{T{}, r, true};
+        }
+        return Entry{*next[r]++, r, false};
+    }
+    // plays all the matches of the subtree rooted at 'node', storing the losers, and returns the winner
+    Entry play(const std::size_t node) noexcept {
+        if (node >= k) {
+            return advance(node - k);
+        }
+        const Entry l{play(2 * node)};
+        const Entry r{play(2 * node + 1)};
+        if (beats(r, l)) {
+            tree[node] = l;
+            return r;
+        }
+        tree[node] = r;
+        return l;
+    }
+
+  public:
+    // Constructor, sets up the tournament over the 'n' runs of 'runs' with k - 1 matches
+    LoserTree(const SortedSpan<T>* runs, const std::size_t n) :
+        next{new const T*[n]}, last{new const T*[n]}, tree{new Entry[n > 0 ? n : 1]}, k{n}, count{0}, compare{} {
+        for (std::size_t r=0; r < k; ++r) {
+            next[r] = runs[r].first;
+            last[r] = runs[r].last;
+            count += last[r] - next[r];
+        }
+        if (k > 0) {
+            tree[0] = play(1);
+        }
+    }
+    LoserTree(const LoserTree&) = delete;
+    LoserTree& operator=(const LoserTree&) = delete;
+    bool is_empty() const noexcept {
+        return count == 0;
+    }
+    // number of elements still to be output
+    std::size_t size() const noexcept {
+        return count;
+    }
+    // returns the minimum, or whatever optimum, of the remaining elements without removing it
+    const T& top() const noexcept {
+        return tree[0].key;
+    }
+    // removes the minimum, or whatever optimum, and returns it
+    T pop() noexcept {
+        const T ans{tree[0].key};
+        --count;
+        // replay the matches from the leaf of the winner up to the root
+        Entry winner{advance(tree[0].run)};
+        for (std::size_t node=(k + winner.run) / 2; node > 0; node /= 2) {
+            if (beats(tree[node], winner)) {
+                const Entry temp{tree[node]};
+                tree[node] = winner;
+                winner = temp;
+            }
+        }
+        tree[0] = winner;
+        return ans;
+    }
+    // writes the next (at most) 'capacity' elements in order to 'out', and returns how many were written
+    std::size_t merge(T* out, const std::size_t capacity) noexcept {
+        const std::size_t m{capacity < count ? capacity : count};
+        for (std::size_t i=0; i < m; ++i) {
+            out[i] = pop();
+        }
+        return m;
+    }
+    // Destructor
+    ~LoserTree() {
+        delete[] next;
+        delete[] last;
+        delete[] tree;
+    }
+};
+
+/**
+  * Merge driven by a BinaryHeap of the heads of the non-exhausted runs. POP replaces the root with the next
+  * element of the same run and pushes it down with the bottom-up HEAPIFY, or removes it if the run is over.
+  * It costs up to 2 log k comparisons per element and moves whole elements, but it only needs the heap.
+  */
+template<class T, class Comp>
+class HeapMerge {
+    // the first element still to be output from a run
+    struct RunHead {
+        T value;  // the element
+        std::size_t run;  // index of the run it comes from
+    };
+    // orders the run heads like their elements
+    struct CompareHeads {
+        Comp compare;
+        bool operator()(const RunHead& a, const RunHead& b) {
+            return compare(a.value, b.value);
+        }
+    };
+
+    BinaryHeap<RunHead, CompareHeads> heads;  // one element per non-exhausted run
+    const T** next;  // next[r] is the element of run r following its head
+    const T** last;  // last[r] is the end of run r
+    std::size_t count;  // number of elements still to be output
+
+  public:
+    // Constructor, builds the heap of the heads of the 'n' runs of 'runs'
+    HeapMerge(const SortedSpan<T>* runs, const std::size_t n) : heads{}, next{new const T*[n]}, last{new const T*[n]}, count{0} {
+        // the heads are gathered first and pushed as one batch, which is heapified in O(n)
+        RunHead* first{new RunHead[n]};
+        std::size_t k{0};
+        for (std::size_t r=0; r < n; ++r) {
+            next[r] = runs[r].first;
+            last[r] = runs[r].last;
+            count += last[r] - next[r];
+            if (next[r] != last[r]) {
+                first[k++] = RunHead{*next[r]++, r};
+            }
+        }
+        heads.reserve(k);
+        heads.push_range(first, k);
+        delete[] first;
+    }
+    HeapMerge(const HeapMerge&) = delete;
+    HeapMerge& operator=(const HeapMerge&) = delete;
+    bool is_empty() const noexcept {
+        return count == 0;
+    }
+    // number of elements still to be output
+    std::size_t size() const noexcept {
+        return count;
+    }
+    // returns the minimum, or whatever optimum, of the remaining elements without removing it
+    const T& top() const noexcept {
+        return heads.top().value;
+    }
+    // removes the minimum, or whatever optimum, and returns it
+    T pop() noexcept {
+        const RunHead& head = heads.top();
+        const T ans{head.value};
+        const std::size_t r{head.run};
+        --count;
+        if (next[r] != last[r]) {
+            heads.sift_down(heads.root(), RunHead{*next[r]++, r});
+        }
+        else {
+            heads.pop();
+        }
+        return ans;
+    }
+    // writes the next (at most) 'capacity' elements in order to 'out', and returns how many were written
+    std::size_t merge(T* out, const std::size_t capacity) noexcept {
+        const std::size_t m{capacity < count ? capacity : count};
+        for (std::size_t i=0; i < m; ++i) {
+            out[i] = pop();
+        }
+        return m;
+    }
+    // Destructor
+    ~HeapMerge() {
+        delete[] next;
+        delete[] last;
+    }
+};
+
+#endif // __KWAY_MERGE__
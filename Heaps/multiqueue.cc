@@ -0,0 +1,109 @@
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <thread>
+
+#include "heap.h"
+#include "multiqueue.h"
+
+#define OPERATIONS 1000000  // number of push/pop pairs per test, split among the threads
+
+/**
+  * The baseline: a single BinaryHeap shared by all the threads behind one mutex
+  */
+struct LockedHeap {
+    std::mutex lock;
+    BinaryHeap<int, Less<int>> heap;
+    void push(const int value) {
+        std::lock_guard<std::mutex> guard{lock};
+        heap.push(value);
+    }
+    bool try_pop(int& value) {
+        std::lock_guard<std::mutex> guard{lock};
+        if (heap.is_empty()) {
+            return false;
+        }
+        value = heap.pop();
+        return true;
+    }
+    std::size_t size() {
+        std::lock_guard<std::mutex> guard{lock};
+        return heap.size;
+    }
+};
+
+/**
+  * Run 'threads' threads, each pushing and popping OPERATIONS / threads random integers on the queue 'q'.
+  * Returns the elapsed time in nanoseconds, and checks that every element pushed has been popped exactly once
+  * and that the size of the queue never exceeds the number of elements pushed (a pop counted before its push
+  * would wrap it around)
+  */
+template<class Q>
+long long run(Q& q, const std::size_t threads) {
+    long long* pushed = new long long[threads];
+    long long* popped = new long long[threads];
+    std::thread* workers = new std::thread[threads];
+    std::atomic<bool> oversized{false};
+    auto start = std::chrono::high_resolution_clock::now();
+    for (std::size_t t=0; t < threads; ++t) {
+        workers[t] = std::thread{[&q, &oversized, pushed, popped, t, threads]() {
+            unsigned state{static_cast<unsigned>(t) + 1};
+            pushed[t] = 0;
+            popped[t] = 0;
+            for (std::size_t i=0; i < OPERATIONS / threads; ++i) {
+                // cheap per-thread pseudo-random keys
+                state = state * 1103515245 + 12345;
+                const int value = state >> 8;
+                q.push(value);
+                pushed[t] += value;
+                int out;
+                if (q.try_pop(out)) {
+                    popped[t] += out;
+                }
+                if (i % 64 == 0 && q.size() > OPERATIONS) {
+                    oversized = true;
+                }
+            }
+        }};
+    }
+    for (std::size_t t=0; t < threads; ++t) {
+        workers[t].join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    // drain what is left and compare the checksums
+    long long total_pushed{0};
+    long long total_popped{0};
+    for (std::size_t t=0; t < threads; ++t) {
+        total_pushed += pushed[t];
+        total_popped += popped[t];
+    }
+    int out;
+    while (q.try_pop(out)) {
+        total_popped += out;
+    }
+    if (total_pushed != total_popped) {
+        std::cout << "ELEMENTS LOST OR DUPLICATED" << std::endl;
+    }
+    if (oversized) {
+        std::cout << "SIZE WRAPPED AROUND" << std::endl;
+    }
+    delete[] workers;
+    delete[] popped;
+    delete[] pushed;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+int main() {
+    // compare the mutex-wrapped heap with the MultiQueue for an increasing number of threads,
+    // each doing the same share of push/pop pairs
+    std::cout << "TESTING THE MULTIQUEUE AGAINST A LOCKED HEAP:" << std::endl;
+    for (std::size_t threads : {1, 2, 4, 8, 16, 32}) {
+        LockedHeap locked;
+        MultiQueue<int, Less<int>> multi{threads};
+        std::cout << "Threads: " << threads << std::endl;
+        std::cout << "Locked heap: " << run(locked, threads) << std::endl;
+        std::cout << "MultiQueue: " << run(multi, threads) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+#ifndef __MULTIQUEUE__
+#define __MULTIQUEUE__
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+
+#include "heap.h"
+
+/**
+  * Relaxed concurrent priority queue (MultiQueue), templated on the type of the data to store and the type of
+  * comparison defining the heap propriety. The elements are spread over c * threads BinaryHeap shards, each
+  * guarded by its own mutex. PUSH puts the element in a random shard, and TRY_POP samples two random shards and
+  * pops the better of their roots; both only ever try_lock a shard and move on to another one if it is busy, so
+  * threads almost never wait for each other. The price is that POP is relaxed: it returns an element close to the
+  * optimum (within O(c * threads) ranks, in expectation), not necessarily the optimum itself. This is fine for
+  * schedulers and for label-correcting algorithms like a parallel Dijkstra, which tolerate out-of-order elements.
+  */
+template<class T, class Comp>
+class MultiQueue {
+    // a shard of the queue; padded so that the mutexes of two shards never share a cache line
+    struct Shard {
+        std::mutex lock;  // guards 'heap'
+        BinaryHeap<T, Comp> heap;  // the elements of the shard
+        char padding[64];  // keeps the next shard's mutex off this shard's cache line
+    };
+
+    Shard* shards;  // array of shards
+    std::size_t num_shards;  // number of shards
+    std::atomic<std::size_t> count;  // number of elements in the whole queue
+    Comp compare;  // comparison operator
+
+    // xorshift random number generator, one state per thread
+    static std::size_t random() noexcept {
+        static thread_local std::size_t state{std::hash<std::thread::id>()(std::this_thread::get_id()) | 1};
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+  public:
+    // Constructor, builds an empty queue for 'threads' threads with 'c' shards per thread
+    explicit MultiQueue(const std::size_t threads, const std::size_t c=2) : shards{nullptr}, num_shards{c * threads}, count{0}, compare{} {
+        if (num_shards < 2) {
+            num_shards = 2;
+        }
+        shards = new Shard[num_shards];
+    }
+    MultiQueue(const MultiQueue&) = delete;
+    MultiQueue& operator=(const MultiQueue&) = delete;
+    // Number of elements in the queue. Only a snapshot, since other threads may be pushing or popping
+    std::size_t size() const noexcept {
+        return count.load(std::memory_order_relaxed);
+    }
+    // Inserts 'value' in a random shard. Safe to call from many threads
+    void push(const T& value) {
+        while (true) {
+            Shard& s = shards[random() % num_shards];
+            if (s.lock.try_lock()) {
+                // counted while the shard is locked, so that a pop of this element, which needs the lock, can
+                // only decrement the count after it has been incremented
+                count.fetch_add(1, std::memory_order_relaxed);
+                s.heap.push(value);
+                s.lock.unlock();
+                return;
+            }
+        }
+    }
+    // Removes an element close to the optimum and stores it in 'value'. Returns false, leaving 'value'
+    // untouched, if the queue is empty. Safe to call from many threads
+    bool try_pop(T& value) {
+        while (count.load(std::memory_order_relaxed) > 0) {
+            // sample two distinct shards and lock whichever are free
+            const std::size_t i{random() % num_shards};
+            std::size_t j{random() % (num_shards - 1)};
+            j = (j >= i) ? j + 1 : j;
+            Shard& a = shards[i];
+            Shard& b = shards[j];
+            const bool locked_a{a.lock.try_lock()};
+            const bool locked_b{b.lock.try_lock()};
+            // among the locked, non-empty shards, pick the one with the better root
+            Shard* best{nullptr};
+            if (locked_a && !a.heap.is_empty()) {
+                best = &a;
+            }
+            if (locked_b && !b.heap.is_empty() && (best == nullptr || compare(b.heap.top(), best->heap.top()))) {
+                best = &b;
+            }
+            if (best != nullptr) {
+                value = best->heap.pop();
+                count.fetch_sub(1, std::memory_order_relaxed);
+            }
+            if (locked_a) {
+                a.lock.unlock();
+            }
+            if (locked_b) {
+                b.lock.unlock();
+            }
+            if (best != nullptr) {
+                return true;
+            }
+        }
+        return false;
+    }
+    // Destructor
+    ~MultiQueue() {
+        delete[] shards;
+    }
+};
+
+#endif // __MULTIQUEUE__
@@ -0,0 +1,143 @@
+#ifndef __PAIRING_HEAP__
+#define __PAIRING_HEAP__
+
+#include <iostream>
+#include <cstdlib>
+
+/**
+  * Pairing heap, templated on the type of the data to store, the type of comparison defining the heap
+  * propriety and the 'Handle' function object mapping each element to an integer in [0, n) (see heap.h).
+  * It exposes the same interface as the addressable BinaryHeap (is_empty, extract_min returning a handle,
+  * decrease taking a handle), so it can be plugged into Dijkstra's algorithm as the queue.
+  * The heap is a multiway tree stored with the leftmost-child/right-sibling representation. DECREASE_KEY
+  * cuts the subtree of the node and links it to the root in O(1) amortized time (the exact bound is still
+  * open, but it is o(log n)), while EXTRACT_MIN pairs the children of the root in two passes, O(log n) amortized.
+  * The nodes live in an array indexed by handle, so no allocation happens after the constructor.
+  */
+template<class T, class Comp, class Handle>
+class PairingHeap {
+    struct Node {
+        T value;  // the element
+        Node* child;  // leftmost child
+        Node* sibling;  // right sibling
+        Node* prev;  // left sibling, or parent if this is the leftmost child; nullptr for the root
+    };
+
+    Node* nodes;  // one node per handle
+    Node* root;  // root of the tree, nullptr if the heap is empty
+    std::size_t size;  // number of elements still in the heap
+    Comp compare;  // comparison operator
+    Handle handle;  // function object computing the handle of an element
+
+    // links the two roots 'a' and 'b', returning the new root: the loser becomes the leftmost child of the winner
+    Node* meld(Node* a, Node* b) noexcept {
+        if (compare(b->value, a->value)) {
+            Node* temp{a};
+            a = b;
+            b = temp;
+        }
+        b->prev = a;
+        b->sibling = a->child;
+        if (a->child != nullptr) {
+            a->child->prev = b;
+        }
+        a->child = b;
+        a->sibling = nullptr;
+        a->prev = nullptr;
+        return a;
+    }
+    // detaches the subtree rooted at 'x' from its parent's list of children
+    void cut(Node* x) noexcept {
+        if (x->prev->child == x) {  // x is the leftmost child, so 'prev' is its parent
+            x->prev->child = x->sibling;
+        }
+        else {
+            x->prev->sibling = x->sibling;
+        }
+        if (x->sibling != nullptr) {
+            x->sibling->prev = x->prev;
+        }
+        x->sibling = nullptr;
+        x->prev = nullptr;
+    }
+    // two-pass pairing of the list of siblings starting at 'first'; returns the new root
+    Node* combine(Node* first) noexcept {
+        if (first == nullptr) {
+            return nullptr;
+        }
+        // first pass, left to right: meld pairs of siblings, and chain the results in reverse order
+        // through the 'sibling' pointer, so that the second pass can walk them right to left
+        Node* pairs{nullptr};
+        while (first != nullptr) {
+            Node* a{first};
+            Node* b{a->sibling};
+            if (b == nullptr) {
+                a->prev = nullptr;
+                a->sibling = pairs;
+                pairs = a;
+                break;
+            }
+            first = b->sibling;
+            Node* m{meld(a, b)};
+            m->sibling = pairs;
+            pairs = m;
+        }
+        // second pass, right to left: meld every pair into the accumulated result
+        Node* result{pairs};
+        pairs = pairs->sibling;
+        result->sibling = nullptr;
+        while (pairs != nullptr) {
+            Node* next{pairs->sibling};
+            result = meld(result, pairs);
+            pairs = next;
+        }
+        return result;
+    }
+
+  public:
+    // constructor, inserts the 'n' elements of 'array' one by one. Each insertion is a single meld, so the build is O(n)
+    PairingHeap(const T* array, const std::size_t n) : nodes{new Node[n]}, root{nullptr}, size{n}, compare{}, handle{} {
+        for (std::size_t i=0; i < n; ++i) {
+            Node* x{&nodes[handle(array[i])]};
+            x->value = array[i];
+            x->child = nullptr;
+            x->sibling = nullptr;
+            x->prev = nullptr;
+            root = (root == nullptr) ? x : meld(root, x);
+        }
+    }
+    PairingHeap(const PairingHeap&) = delete;
+    PairingHeap& operator=(const PairingHeap&) = delete;
+    bool is_empty() const noexcept {
+        return size == 0;
+    }
+    // removes the minimum, or whatever optimum, and returns its handle
+    std::size_t extract_min() noexcept {
+        Node* min{root};
+        root = combine(min->child);
+        min->child = nullptr;
+        --size;
+        return min - nodes;
+    }
+    // decreases the element with handle 'h' to 'value', which must have the same handle
+    void decrease(const std::size_t h, const T& value) {
+        Node* x{&nodes[h]};
+        // if the value does not imply a decrease, abort the program
+        if (compare(x->value, value)) {
+            std::cout << "value is not smaller than H[i]" << std::endl;
+            abort();
+        }
+        x->value = value;
+        // the root stays where it is; any other node is cut and linked again to the root
+        if (x != root) {
+            cut(x);
+            root = meld(root, x);
+        }
+    }
+    // destructor
+    ~PairingHeap() {
+        delete[] nodes;
+    }
+};
+
+#endif // __PAIRING_HEAP__
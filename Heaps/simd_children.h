@@ -0,0 +1,91 @@
+#ifndef __SIMD_CHILDREN__
+#define __SIMD_CHILDREN__
+
+/**
+  * This header file contains the kernels used by wide heaps of integer keys to find the best among
+  * the W contiguous children of a node, that is the position of their minimum (or maximum, when 'Max'
+  * is true). The vectorized AVX2 kernels compute the horizontal minimum with a few min and shuffle
+  * instructions, compare it against the keys and take the first set bit of the movemask, so no branch
+  * depends on the data. They are compiled with the 'target' attribute, so the rest of the program does
+  * not need -mavx2, and 'BestOf' picks them at runtime only if the CPU supports AVX2.
+  */
+
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_CHILDREN_X86
+#endif
+
+/**
+  * Scalar fallback, the same loop as the one of the heap
+  */
+template<bool Max, std::size_t W>
+std::size_t scalar_best_of(const int* keys) noexcept {
+    std::size_t m{0};
+    for (std::size_t c=1; c < W; ++c) {
+        if (Max ? keys[c] > keys[m] : keys[c] < keys[m]) {
+            m = c;
+        }
+    }
+    return m;
+}
+
+#ifdef SIMD_CHILDREN_X86
+// lane-wise minimum or maximum of two vectors
+template<bool Max>
+__attribute__((target("avx2"))) inline __m256i avx2_best(const __m256i a, const __m256i b) noexcept {
+    return Max ? _mm256_max_epi32(a, b) : _mm256_min_epi32(a, b);
+}
+
+// broadcast the minimum (or maximum) of the 8 lanes of 'v' to all of them
+template<bool Max>
+__attribute__((target("avx2"))) inline __m256i avx2_reduce(__m256i v) noexcept {
+    v = avx2_best<Max>(v, _mm256_permute2x128_si256(v, v, 1));  // swap the two 128-bit halves
+    v = avx2_best<Max>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));  // swap pairs of lanes
+    return avx2_best<Max>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));  // swap adjacent lanes
+}
+
+// bit i of the result is set if lane i of 'v' equals the corresponding lane of 'best'
+__attribute__((target("avx2"))) inline unsigned avx2_mask(const __m256i v, const __m256i best) noexcept {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, best)));
+}
+
+template<bool Max>
+__attribute__((target("avx2"))) std::size_t avx2_best_of8(const int* keys) noexcept {
+    const __m256i v{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys))};
+    return __builtin_ctz(avx2_mask(v, avx2_reduce<Max>(v)));
+}
+
+template<bool Max>
+__attribute__((target("avx2"))) std::size_t avx2_best_of16(const int* keys) noexcept {
+    const __m256i lo{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys))};
+    const __m256i hi{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + 8))};
+    const __m256i best{avx2_reduce<Max>(avx2_best<Max>(lo, hi))};
+    return __builtin_ctz(avx2_mask(lo, best) | (avx2_mask(hi, best) << 8));
+}
+#endif
+
+/**
+  * Runtime dispatch of the kernels for W = 8 and W = 16. The choice is made once, on the first call
+  */
+template<bool Max, std::size_t W>
+struct BestOf {
+    static_assert(W == 8 || W == 16, "the kernels handle 8 or 16 children");
+    typedef std::size_t (*Kernel)(const int*);
+    static Kernel choose() noexcept {
+#ifdef SIMD_CHILDREN_X86
+        if (__builtin_cpu_supports("avx2")) {
+            return W == 8 ? avx2_best_of8<Max> : avx2_best_of16<Max>;
+        }
+#endif
+        return scalar_best_of<Max, W>;
+    }
+    // position of the best of the W keys starting at 'keys'
+    static std::size_t find(const int* keys) noexcept {
+        static const Kernel kernel{choose()};
+        return kernel(keys);
+    }
+};
+
+#endif // __SIMD_CHILDREN__
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+
+#include "heap.h"
+#include "topk.h"
+
+/**
+  * Check TopK against a full BinaryHeap on 'n' random scores: the k largest, popped from a max-heap of all the
+  * scores, must be exactly the ones drained from the selection. With 'threads' > 1 the input is split in
+  * contiguous parts, each selected by its own thread, and the partial results are merged
+  */
+bool check(const std::size_t n, const std::size_t k, const std::size_t threads) {
+    int* scores{new int[n]};
+    for (std::size_t i=0; i < n; ++i) {
+        scores[i] = rand() % 100000;
+    }
+    TopK<int, Less<int>> best{k};
+    TopK<int, Less<int>>** partial{new TopK<int, Less<int>>*[threads]};
+    std::thread* workers{new std::thread[threads]};
+    for (std::size_t t=0; t < threads; ++t) {
+        partial[t] = new TopK<int, Less<int>>{k};
+        workers[t] = std::thread([=] {
+            partial[t]->offer_range(scores + t * n / threads, (t + 1) * n / threads - t * n / threads);
+        });
+    }
+    for (std::size_t t=0; t < threads; ++t) {
+        workers[t].join();
+        best.merge(*partial[t]);
+        delete partial[t];
+    }
+    delete[] workers;
+    delete[] partial;
+    const std::size_t m{best.size()};
+    int* selected{new int[m]};
+    best.drain(selected);
+    BinaryHeap<int, Greater<int>> reference{scores, n};
+    bool correct{m == (k < n ? k : n)};
+    for (std::size_t i=0; correct && i < m; ++i) {
+        correct = selected[i] == reference.pop();
+    }
+    delete[] selected;
+    delete[] scores;
+    return correct;
+}
+
+int main() {
+    std::cout << "TESTING TOP-K AGAINST A BINARYHEAP:" << std::endl;
+    for (std::size_t k : {0, 1, 10, 100, 5000}) {
+        for (std::size_t threads : {1, 4}) {
+            std::cout << "k: " << k << " Threads: " << threads << " "
+                      << (check(100000, k, threads) && check(k / 2, k, threads) ? "correct" : "WRONG") << std::endl;
+        }
+    }
+
+    // the following block of code selects the top 100 of 'dim' random scores, once with TopK and once by
+    // building a max-heap of all of them and popping 100 times. Timings are taken in milliseconds
+    std::cout << "TESTING TOP-100 SELECTION:" << std::endl;
+    for (std::size_t dim : {1000000, 10000000, 50000000}) {
+        int* scores{new int[dim]};
+        for (std::size_t i=0; i < dim; ++i) {
+            scores[i] = rand();
+        }
+        int top[100];
+        auto start = std::chrono::high_resolution_clock::now();
+        TopK<int, Less<int>> best{100};
+        best.offer_range(scores, dim);
+        best.drain(top);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "Size: " << dim << " TopK: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        start = std::chrono::high_resolution_clock::now();
+        BinaryHeap<int, Greater<int>> h{scores, dim};
+        for (std::size_t i=0; i < 100; ++i) {
+            top[i] = h.pop();
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << " Full heap: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << std::endl;
+        delete[] scores;
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#ifndef __TOPK__
+#define __TOPK__
+
+#include "heap.h"
+
+/**
+  * Bounded top-k selection, templated on the type of the data and the type of comparison. It keeps the k
+  * greatest elements offered so far according to 'Comp' (so TopK<int, Less<int>> keeps the k largest ints)
+  * in a BinaryHeap of fixed capacity k, whose root is the worst element kept: the threshold an element must
+  * beat to get in. Most elements of a long stream are rejected with a single comparison against the root,
+  * and the others replace it with one bottom-up HEAPIFY, so offering n elements costs O(n + m log k), where m
+  * is the number of replacements (O(k log(n/k)) in expectation for a random order). Memory stays O(k).
+  * Partial results computed by different threads on different parts of the input can be merged.
+  */
+template<class T, class Comp>
+class TopK {
+    BinaryHeap<T, Comp> heap;  // the elements kept; the root is the worst of them
+    std::size_t k;  // maximum number of elements kept
+    Comp compare;  // comparison operator
+
+  public:
+    // Constructor, builds an empty selection of the best 'capacity' elements
+    explicit TopK(const std::size_t capacity) : heap{}, k{capacity}, compare{} {
+        heap.reserve(k);
+    }
+    TopK(const TopK&) = delete;
+    TopK& operator=(const TopK&) = delete;
+    // number of elements kept, at most k
+    std::size_t size() const noexcept {
+        return heap.size;
+    }
+    // the worst element kept; once k elements are kept, an element must be better than this to get in
+    const T& threshold() const noexcept {
+        return heap.top();
+    }
+    // offer 'value' to the selection: it gets in if fewer than k elements are kept, or if it beats the threshold
+    void offer(const T& value) {
+        if (heap.size < k) {
+            heap.push(value);
+        }
+        else if (k > 0 && compare(heap.top(), value)) {
+            // replace the root and push it down
+            heap.sift_down(heap.root(), value);
+        }
+    }
+    // offer the 'n' elements of 'array'. While the selection is not full, the elements are appended as a batch
+    // with PUSH_RANGE; the rest go through the threshold test one by one
+    void offer_range(const T* array, const std::size_t n) {
+        std::size_t i{0};
+        if (heap.size < k) {
+            i = (k - heap.size < n) ? k - heap.size : n;
+            heap.push_range(array, i);
+        }
+        for (; i < n; ++i) {
+            offer(array[i]);
+        }
+    }
+    // merge the selection 'other', computed for example by another thread on another part of the input
+    void merge(const TopK& other) {
+        offer_range(other.heap.data, other.heap.size);
+    }
+    // empty the selection, writing the elements kept to 'out' from the best to the worst
+    void drain(T* out) {
+        for (std::size_t i=heap.size; i > 0; --i) {
+            out[i-1] = heap.pop();
+        }
+    }
+};
+
+#endif // __TOPK__
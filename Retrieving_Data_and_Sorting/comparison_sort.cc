@@ -71,23 +71,31 @@ struct CompareItems {
     }
 };
 
+/**
+  * 64-byte record with an integer key, used to test heapsort on elements that are expensive to copy
+  */
+struct Record {
+    int key;  // sort key
+    int payload[15];  // padding up to 64 bytes
+    bool operator>(const Record& other) const noexcept {
+        return key > other.key;
+    }
+};
+
 /**
   * Heapsort sorting algorithm. Takes an array to sort 'A' and its length 'n'. Sorts in-place by building a max-heap,
   * defined in the heap.h header. Reassigning the pointer to the array allows us to implement it in-place.
-  * The template is on the type of the array to sort
+  * The template is on the type of the array to sort and on the arity 'D' of the heap (binary by default).
+  * The max-heap is built with 'threads' threads
   */
-template<class T>
-void heapsort(T* A, const std::size_t n) {
+template<class T, std::size_t D=2>
+void heapsort(T* A, const std::size_t n, const std::size_t threads=1) {
     // build a max-heap, the root will be the maximum
-    BinaryHeap<T, CompareItems<T>> h{A, n, true};   //CompareItems allows us to represent a max-heap
-    // for each element - 1
+    DaryHeap<T, CompareItems<T>, D> h{A, n, true, threads};   //CompareItems allows us to represent a max-heap
+    // for each element - 1, pop the root and store it in the slot freed by the last leaf.
+    // POP fixes the max-heap with the bottom-up variant of HEAPIFY, which saves about half of the comparisons
     for (std::size_t i=n-1; i >= 1; --i) {
-        // swap the i-th element with the root
-        h.swap(i, 0);
-        // remove the last leaf
-        --h.size;
-        // fix the max-heap
-        h.heapify(0);
+        A[i] = h.pop();
     }
     // since the 'data' member of the heap points to the same
     // memory location as 'A', the array has been sorted
@@ -204,5 +212,25 @@ int main() {
         std::cout << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << std::endl;
     }
 
+    // the following block of code tests the execution time of Heapsort on 64-byte records, where
+    // the copies saved by the hole-based HEAPIFY matter the most
+
+    std::cout << "TESTING THE IMPLEMENTATION OF HEAPSORT ON 64-BYTE RECORDS:" << std::endl;
+    for (std::size_t dim : {10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000}) {
+        Record* test = new Record[dim];
+        // initialize array of random keys
+        for (std::size_t i=0; i < dim; ++i) {
+            test[i].key = rand()%(2*MAX_VALUE)-MAX_VALUE;
+        }
+        // measure time
+        auto start = std::chrono::high_resolution_clock::now();
+        heapsort(test, dim);
+        auto end = std::chrono::high_resolution_clock::now();
+        // print result
+        std::cout << "Size: " << dim << std::endl;
+        std::cout << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << std::endl;
+        delete[] test;
+    }
+
     return 0;
 }
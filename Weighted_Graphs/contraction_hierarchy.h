@@ -0,0 +1,684 @@
+#ifndef __CONTRACTION_HIERARCHY__
+#define __CONTRACTION_HIERARCHY__
+
+/**
+  * This header file contains the Contraction Hierarchies of Geisberger, Sanders, Schultes and Delling, a preprocessing
+  * of a static graph that answers point-to-point shortest path queries by exploring only a few hundred vertices.
+  * The vertices are contracted one after the other, from the least important to the most important: contracting v
+  * removes it from the graph, and adds a shortcut u -> x of weight w(u, v) + w(v, x) for each pair of neighbors whose
+  * shortest path passes through v, so that the distances among the remaining vertices do not change. The rank of a
+  * vertex is its position in the contraction order. A query then runs a bidirectional search in which both sides
+  * only follow edges towards vertices of higher rank, and meets at the highest vertex of a shortest path.
+  */
+
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "graph_utilities.h"
+#include "csr_graph.h"
+#include "graph_io.h"
+#include "point_to_point.h"
+#include "heap.h"
+
+#define HIERARCHY_VERSION 1  // version of the hierarchy file format, to be bumped at every incompatible change
+#define WITNESS_LIMIT 500  // vertices settled by a witness search before it gives up
+#define ESTIMATE_LIMIT 50  // the same, for the searches that only estimate the priority of a vertex
+
+/**
+  * Edge of the graph being contracted, or of the hierarchy: 'middle' is the vertex a shortcut skips, -1 for an edge of
+  * the original graph
+  */
+struct Arc {
+    int target;  // the other endpoint
+    int weight;  // the weight
+    int middle;  // the contracted vertex between the endpoints, -1 for an original edge
+};
+
+/**
+  * Growable array of arcs, with at most one arc per endpoint
+  */
+struct ArcList {
+    Arc* arcs;
+    std::size_t size;
+    std::size_t capacity;
+
+    ArcList() : arcs{nullptr}, size{0}, capacity{0} {}
+    ArcList(const ArcList&) = delete;
+    ArcList& operator=(const ArcList&) = delete;
+    // add an arc towards 'target', or lower the weight of the existing one; returns whether anything changed
+    bool add_or_lower(const int target, const int weight, const int middle) {
+        for (std::size_t i=0; i < size; ++i) {
+            if (arcs[i].target == target) {
+                if (weight >= arcs[i].weight) {
+                    return false;
+                }
+                arcs[i].weight = weight;
+                arcs[i].middle = middle;
+                return true;
+            }
+        }
+        if (size == capacity) {
+            capacity = (capacity == 0) ? 4 : 2 * capacity;
+            Arc* new_arcs{new Arc[capacity]};
+            for (std::size_t i=0; i < size; ++i) {
+                new_arcs[i] = arcs[i];
+            }
+            delete[] arcs;
+            arcs = new_arcs;
+        }
+        arcs[size++] = Arc{target, weight, middle};
+        return true;
+    }
+    // remove the arc towards 'target', if any, moving the last arc in its place
+    void remove(const int target) noexcept {
+        for (std::size_t i=0; i < size; ++i) {
+            if (arcs[i].target == target) {
+                arcs[i] = arcs[--size];
+                return;
+            }
+        }
+    }
+    // release the memory of the arcs
+    void clear() noexcept {
+        delete[] arcs;
+        arcs = nullptr;
+        size = 0;
+        capacity = 0;
+    }
+    ~ArcList() {
+        delete[] arcs;
+    }
+};
+
+/**
+  * Workspace of the witness searches of one thread: a Dijkstra's search from u that avoids the vertex being contracted,
+  * looking for paths to its neighbors at most as long as the ones through it. It is bounded by a distance and by
+  * a number of settled vertices; when it gives up early, the shortcut is added even if it was not needed, which
+  * costs a little space but never correctness. It also stops as soon as all the neighbors have been settled.
+  * Only the distances touched by a search are reset by the next one
+  */
+struct WitnessSearch {
+    int* dist;  // tentative distance of each vertex from the source, INT_MAX if not reached
+    int* touched;  // the vertices whose distance has been set by the current search
+    std::size_t num_touched;  // number of vertices in 'touched'
+    char* target;  // flags the neighbors whose witnesses are looked for
+    BinaryHeap<SearchEntry, CompareEntries> heap;  // the queue
+
+    explicit WitnessSearch(const std::size_t n) : dist{new int[n]}, touched{new int[n]}, num_touched{0}, target{new char[n]}, heap{} {
+        for (std::size_t v=0; v < n; ++v) {
+            dist[v] = INT_MAX;
+            target[v] = 0;
+        }
+    }
+    WitnessSearch(const WitnessSearch&) = delete;
+    WitnessSearch& operator=(const WitnessSearch&) = delete;
+    // search from 'source' along the arcs 'out', skipping 'avoid' and the vertices x for which 'blocked(x)' is true,
+    // and stopping at distance 'limit', after settling 'max_settled' vertices, or once the 'targets' vertices flagged
+    // in 'target' other than the source have been settled
+    template<class Blocked>
+    void run(const ArcList* out, Blocked blocked, const int source, const int avoid, const long long limit, const std::size_t max_settled,
+             std::size_t targets) {
+        for (std::size_t i=0; i < num_touched; ++i) {
+            dist[touched[i]] = INT_MAX;
+        }
+        num_touched = 0;
+        heap.size = 0;
+        dist[source] = 0;
+        touched[num_touched++] = source;
+        heap.push(SearchEntry{0, source});
+        for (std::size_t settled=0; !heap.is_empty() && settled < max_settled; ++settled) {
+            const SearchEntry e{heap.pop()};
+            if (e.d > dist[e.v]) {
+                continue;
+            }
+            if (e.d > limit || (target[e.v] && e.v != source && --targets == 0)) {
+                return;
+            }
+            const ArcList& arcs = out[e.v];
+            for (std::size_t i=0; i < arcs.size; ++i) {
+                const int x{arcs.arcs[i].target};
+                const int d{e.d + arcs.arcs[i].weight};
+                if (x == avoid || d >= dist[x] || blocked(x)) {
+                    continue;
+                }
+                if (dist[x] == INT_MAX) {
+                    touched[num_touched++] = x;
+                }
+                dist[x] = d;
+                heap.push(SearchEntry{d, x});
+            }
+        }
+    }
+    ~WitnessSearch() {
+        delete[] dist;
+        delete[] touched;
+        delete[] target;
+    }
+};
+
+/**
+  * Header of the file of a ContractionHierarchy, followed by the ranks and by the offsets, targets, weights and
+  * middle vertices of the upward and of the downward graph
+  */
+struct HierarchyHeader {
+    char magic[8];  // "HIERARCH"
+    std::uint32_t version;  // HIERARCHY_VERSION of the program that wrote it
+    std::uint32_t byte_order;  // SNAPSHOT_BYTE_ORDER, in the byte order of the machine that wrote it
+    std::uint64_t n;  // number of vertices
+    std::uint64_t up_edges;  // number of edges of the upward graph
+    std::uint64_t down_edges;  // number of edges of the downward graph
+};
+
+/**
+  * The hierarchy of a graph: the rank of each vertex, and the edges of the graph plus the shortcuts split in two
+  * CSRGraphs. The upward graph holds the edges u -> x with rank[u] < rank[x], followed by the forward search; the
+  * downward graph holds the edges x -> u with rank[x] > rank[u], reversed and stored at u, followed by the backward
+  * search. Every edge of the graph is in one of them, so together they have the original edges plus the shortcuts:
+  * on the grids with highways of the tests, about 2.3 times the original edges (89194 against 39600 at 100 x 100,
+  * 810342 against 358800 at 300 x 300), for a preprocessing of about 1 and 10 seconds on one core.
+  * Preprocessing contracts the vertices in rounds. In each round, the priority of a vertex is its edge difference,
+  * the number of shortcuts its contraction would add minus the number of edges it would remove, plus the number of
+  * its neighbors already contracted, which spreads the contractions evenly over the graph. Every vertex whose
+  * priority is lower than the one of all its neighbors is contracted in the round: these vertices form an
+  * independent set, so their witness searches, which avoid all of them, run in parallel on the same graph, and their
+  * shortcuts are added together at the end of the round. Then only the priorities of their neighbors are updated.
+  */
+class ContractionHierarchy {
+    std::size_t n;  // number of vertices
+    int* ranks;  // position of each vertex in the contraction order
+    CSRGraph* up;  // the upward graph
+    CSRGraph* down;  // the downward graph, reversed
+    int* up_middle;  // middle vertex of each edge of 'up', -1 for an original edge
+    int* down_middle;  // middle vertex of each edge of 'down', -1 for an original edge
+
+    // a shortcut found by a witness search, to be added at the end of the round
+    struct Shortcut {
+        int source;
+        int target;
+        int weight;
+        int middle;
+    };
+    // growable array of shortcuts, one per thread
+    struct ShortcutList {
+        Shortcut* items;
+        std::size_t size;
+        std::size_t capacity;
+
+        ShortcutList() : items{nullptr}, size{0}, capacity{0} {}
+        ShortcutList(const ShortcutList&) = delete;
+        ShortcutList& operator=(const ShortcutList&) = delete;
+        void push(const Shortcut& s) {
+            if (size == capacity) {
+                capacity = (capacity == 0) ? 64 : 2 * capacity;
+                Shortcut* new_items{new Shortcut[capacity]};
+                for (std::size_t i=0; i < size; ++i) {
+                    new_items[i] = items[i];
+                }
+                delete[] items;
+                items = new_items;
+            }
+            items[size++] = s;
+        }
+        ~ShortcutList() {
+            delete[] items;
+        }
+    };
+
+    // call 'emit(u, x, weight)' for each shortcut u -> x needed to contract v, given its arcs 'out' and 'in' among the
+    // remaining vertices; the witness searches skip the vertices x for which 'blocked(x)' is true, and settle at most
+    // 'max_settled' vertices
+    template<class Blocked, class Emit>
+    static void find_shortcuts(const int v, const ArcList* out, const ArcList* in, Blocked blocked, const std::size_t max_settled,
+                               WitnessSearch& witness, Emit emit) {
+        int max_out{0};
+        for (std::size_t j=0; j < out[v].size; ++j) {
+            max_out = (out[v].arcs[j].weight > max_out) ? out[v].arcs[j].weight : max_out;
+            witness.target[out[v].arcs[j].target] = 1;
+        }
+        for (std::size_t i=0; i < in[v].size; ++i) {
+            const Arc& a = in[v].arcs[i];
+            const std::size_t targets{out[v].size - witness.target[a.target]};
+            if (targets == 0) {
+                continue;
+            }
+            witness.run(out, blocked, a.target, v, static_cast<long long>(a.weight) + max_out, max_settled, targets);
+            for (std::size_t j=0; j < out[v].size; ++j) {
+                const Arc& b = out[v].arcs[j];
+                const long long through{static_cast<long long>(a.weight) + b.weight};
+                if (b.target != a.target && through < witness.dist[b.target]) {
+                    emit(a.target, b.target, static_cast<int>(through));
+                }
+            }
+        }
+        for (std::size_t j=0; j < out[v].size; ++j) {
+            witness.target[out[v].arcs[j].target] = 0;
+        }
+    }
+    // turn the arcs kept by each vertex when it was contracted into a CSRGraph and its array of middle vertices
+    static CSRGraph* build(const std::size_t n, const ArcList* arcs, int*& middle) {
+        std::size_t* offsets{new std::size_t[n + 1]};
+        offsets[0] = 0;
+        for (std::size_t v=0; v < n; ++v) {
+            offsets[v + 1] = offsets[v] + arcs[v].size;
+        }
+        const std::size_t m{offsets[n]};
+        int* targets{new int[m]};
+        int* weights{new int[m]};
+        middle = new int[m];
+        for (std::size_t v=0; v < n; ++v) {
+            for (std::size_t i=0; i < arcs[v].size; ++i) {
+                targets[offsets[v] + i] = arcs[v].arcs[i].target;
+                weights[offsets[v] + i] = arcs[v].arcs[i].weight;
+                middle[offsets[v] + i] = arcs[v].arcs[i].middle;
+            }
+        }
+        CSRGraph* graph{new CSRGraph{n, m, offsets, targets, weights}};
+        graph->owned = true;
+        return graph;
+    }
+    // contract the vertices of 'graph' on 'threads' threads, filling the ranks and the two graphs
+    void contract(const CSRGraph& graph, const std::size_t threads) {
+        ArcList* out{new ArcList[n]};  // arcs leaving each vertex, towards the remaining vertices
+        ArcList* in{new ArcList[n]};  // arcs entering each vertex, from the remaining vertices
+        ArcList* up_arcs{new ArcList[n]};  // the arcs out of each vertex when it was contracted
+        ArcList* down_arcs{new ArcList[n]};  // the arcs into each vertex when it was contracted
+        for (std::size_t u=0; u < n; ++u) {
+            for (std::size_t e=graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+                const int x{graph.targets[e]};
+                if (x != static_cast<int>(u) && out[u].add_or_lower(x, graph.weights[e], -1)) {
+                    in[x].add_or_lower(u, graph.weights[e], -1);
+                }
+            }
+        }
+        int* priority{new int[n]};
+        int* deleted{new int[n]};  // number of neighbors already contracted
+        char* selected_now{new char[n]};  // the vertices contracted in the current round
+        char* dirty{new char[n]};  // the vertices whose priority must be updated
+        int* selected{new int[n]};  // the vertices of the current round, then the dirty ones
+        WitnessSearch** witness{new WitnessSearch*[threads]};
+        ShortcutList* shortcuts{new ShortcutList[threads]};
+        for (std::size_t t=0; t < threads; ++t) {
+            witness[t] = new WitnessSearch{n};
+        }
+        for (std::size_t v=0; v < n; ++v) {
+            deleted[v] = 0;
+            selected_now[v] = 0;
+            dirty[v] = 0;
+            ranks[v] = -1;
+        }
+        const auto update = [&](const std::size_t v, const std::size_t t) {
+            int added{0};
+            find_shortcuts(v, out, in, [](int) {return false;}, ESTIMATE_LIMIT, *witness[t], [&added](int, int, int) {++added;});
+            priority[v] = added - static_cast<int>(in[v].size + out[v].size) + deleted[v];
+        };
+        // ties are broken by a hash of the indices, so that the rounds do not sweep the graph in index order
+        const auto key = [&priority](const int v) {
+            return static_cast<long long>(priority[v]) * 4294967296LL + (static_cast<std::uint32_t>(v) * 2654435761u);
+        };
+        parallel_for(n, threads, update);
+        std::size_t contracted{0};
+        while (contracted < n) {
+            std::size_t count{0};
+            for (std::size_t v=0; v < n; ++v) {
+                if (ranks[v] != -1) {
+                    continue;
+                }
+                bool minimum{true};
+                for (std::size_t i=0; i < out[v].size && minimum; ++i) {
+                    minimum = key(v) < key(out[v].arcs[i].target);
+                }
+                for (std::size_t i=0; i < in[v].size && minimum; ++i) {
+                    minimum = key(v) < key(in[v].arcs[i].target);
+                }
+                if (minimum) {
+                    selected[count++] = v;
+                }
+            }
+            for (std::size_t i=0; i < count; ++i) {
+                selected_now[selected[i]] = 1;
+                ranks[selected[i]] = contracted++;
+            }
+            parallel_for(count, threads, [&](const std::size_t i, const std::size_t t) {
+                const int v{selected[i]};
+                // the vertices of the round are contracted as if one after the other in the order of their keys: a
+                // witness can pass through the later ones, which are still there, but not through the earlier ones
+                const auto earlier = [&](const int x) {return selected_now[x] && key(x) < key(v);};
+                find_shortcuts(v, out, in, earlier, WITNESS_LIMIT, *witness[t], [&shortcuts, t, v](const int u, const int x, const int weight) {
+                    shortcuts[t].push(Shortcut{u, x, weight, v});
+                });
+            });
+            // remove the vertices of the round, keeping their arcs in the hierarchy
+            for (std::size_t i=0; i < count; ++i) {
+                const int v{selected[i]};
+                for (std::size_t j=0; j < out[v].size; ++j) {
+                    const Arc& a = out[v].arcs[j];
+                    up_arcs[v].add_or_lower(a.target, a.weight, a.middle);
+                    in[a.target].remove(v);
+                    ++deleted[a.target];
+                    dirty[a.target] = 1;
+                }
+                for (std::size_t j=0; j < in[v].size; ++j) {
+                    const Arc& a = in[v].arcs[j];
+                    down_arcs[v].add_or_lower(a.target, a.weight, a.middle);
+                    out[a.target].remove(v);
+                    ++deleted[a.target];
+                    dirty[a.target] = 1;
+                }
+                out[v].clear();
+                in[v].clear();
+                selected_now[v] = 0;
+            }
+            for (std::size_t t=0; t < threads; ++t) {
+                for (std::size_t i=0; i < shortcuts[t].size; ++i) {
+                    const Shortcut& s = shortcuts[t].items[i];
+                    if (out[s.source].add_or_lower(s.target, s.weight, s.middle)) {
+                        in[s.target].add_or_lower(s.source, s.weight, s.middle);
+                    }
+                }
+                shortcuts[t].size = 0;
+            }
+            count = 0;
+            for (std::size_t v=0; v < n; ++v) {
+                if (dirty[v] && ranks[v] == -1) {
+                    selected[count++] = v;
+                }
+                dirty[v] = 0;
+            }
+            parallel_for(count, threads, [&](const std::size_t i, const std::size_t t) {update(selected[i], t);});
+        }
+        up = build(n, up_arcs, up_middle);
+        down = build(n, down_arcs, down_middle);
+        for (std::size_t t=0; t < threads; ++t) {
+            delete witness[t];
+        }
+        delete[] witness;
+        delete[] shortcuts;
+        delete[] selected;
+        delete[] dirty;
+        delete[] selected_now;
+        delete[] deleted;
+        delete[] priority;
+        delete[] down_arcs;
+        delete[] up_arcs;
+        delete[] in;
+        delete[] out;
+    }
+    // read a CSRGraph and its middle vertices, with 'm' edges, from 'p', moving it past them
+    CSRGraph* read_graph(const char*& p, const std::size_t m, int*& middle) const {
+        std::size_t* offsets{new std::size_t[n + 1]};
+        int* targets{new int[m]};
+        int* weights{new int[m]};
+        middle = new int[m];
+        std::memcpy(offsets, p, (n + 1) * sizeof(std::size_t));
+        p += (n + 1) * sizeof(std::size_t);
+        std::memcpy(targets, p, m * sizeof(int));
+        p += m * sizeof(int);
+        std::memcpy(weights, p, m * sizeof(int));
+        p += m * sizeof(int);
+        std::memcpy(middle, p, m * sizeof(int));
+        p += m * sizeof(int);
+        CSRGraph* graph{new CSRGraph{n, m, offsets, targets, weights}};
+        graph->owned = true;
+        return graph;
+    }
+    // write 'graph' and its middle vertices to 'fd'
+    static void write_graph(const int fd, const CSRGraph& graph, const int* middle, const char* path) {
+        write_all(fd, graph.offsets, (graph.n + 1) * sizeof(std::size_t), path);
+        write_all(fd, graph.targets, graph.m * sizeof(int), path);
+        write_all(fd, graph.weights, graph.m * sizeof(int), path);
+        write_all(fd, middle, graph.m * sizeof(int), path);
+    }
+
+  public:
+    // Constructor, preprocesses 'graph' on 'threads' threads
+    explicit ContractionHierarchy(const CSRGraph& graph, const std::size_t threads=default_threads()) :
+        n{graph.n}, ranks{new int[graph.n]}, up{nullptr}, down{nullptr}, up_middle{nullptr}, down_middle{nullptr} {
+        contract(graph, threads > 0 ? threads : 1);
+    }
+    // Constructor, loads the hierarchy saved in the file 'path'. A file with a different version or byte order, or
+    // truncated, aborts the program
+    explicit ContractionHierarchy(const char* path) :
+        n{0}, ranks{nullptr}, up{nullptr}, down{nullptr}, up_middle{nullptr}, down_middle{nullptr} {
+        const MappedFile file{path};
+        HierarchyHeader header;
+        if (file.size < sizeof(header)) {
+            std::cout << path << " is not a contraction hierarchy" << std::endl;
+            abort();
+        }
+        std::memcpy(&header, file.data, sizeof(header));
+        if (std::memcmp(header.magic, "HIERARCH", sizeof(header.magic)) != 0) {
+            std::cout << path << " is not a contraction hierarchy" << std::endl;
+            abort();
+        }
+        if (header.version != HIERARCHY_VERSION || header.byte_order != SNAPSHOT_BYTE_ORDER) {
+            std::cout << path << " has version " << header.version << " or byte order " << header.byte_order
+                      << ", expected " << HIERARCHY_VERSION << " and " << SNAPSHOT_BYTE_ORDER << std::endl;
+            abort();
+        }
+        n = header.n;
+        if (file.size != sizeof(header) + n * sizeof(int) + 2 * (n + 1) * sizeof(std::size_t)
+                         + 3 * (header.up_edges + header.down_edges) * sizeof(int)) {
+            std::cout << path << " is truncated or corrupted" << std::endl;
+            abort();
+        }
+        const char* p{file.data + sizeof(header)};
+        ranks = new int[n];
+        std::memcpy(ranks, p, n * sizeof(int));
+        p += n * sizeof(int);
+        up = read_graph(p, header.up_edges, up_middle);
+        down = read_graph(p, header.down_edges, down_middle);
+    }
+    ContractionHierarchy(const ContractionHierarchy&) = delete;
+    ContractionHierarchy& operator=(const ContractionHierarchy&) = delete;
+    // save the hierarchy to the file 'path', to be loaded by the constructor above
+    void save(const char* path) const {
+        static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "hierarchy files store the offsets as they are in memory");
+        const int fd{open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+        if (fd == -1) {
+            io_fail("open", path);
+        }
+        HierarchyHeader header;
+        std::memcpy(header.magic, "HIERARCH", sizeof(header.magic));
+        header.version = HIERARCHY_VERSION;
+        header.byte_order = SNAPSHOT_BYTE_ORDER;
+        header.n = n;
+        header.up_edges = up->m;
+        header.down_edges = down->m;
+        write_all(fd, &header, sizeof(header), path);
+        write_all(fd, ranks, n * sizeof(int), path);
+        write_graph(fd, *up, up_middle, path);
+        write_graph(fd, *down, down_middle, path);
+        if (close(fd) != 0) {
+            io_fail("close", path);
+        }
+    }
+    // number of vertices
+    std::size_t size() const noexcept {
+        return n;
+    }
+    // number of edges of the hierarchy, original edges and shortcuts
+    std::size_t edges() const noexcept {
+        return up->m + down->m;
+    }
+    int rank(const int v) const noexcept {
+        return ranks[v];
+    }
+    // the graph searched by the forward search (upward) or by the backward search (downward, reversed)
+    const CSRGraph& graph(const bool backward) const noexcept {
+        return backward ? *down : *up;
+    }
+    // the vertex skipped by the shortcut u -> x, -1 if it is an edge of the original graph. Aborts the program if
+    // the hierarchy has no such edge
+    int middle(const int u, const int x) const {
+        const bool upward{ranks[u] < ranks[x]};
+        const CSRGraph& g = upward ? *up : *down;
+        const int from{upward ? u : x};
+        const int to{upward ? x : u};
+        for (std::size_t e=g.offsets[from]; e < g.offsets[from + 1]; ++e) {
+            if (g.targets[e] == to) {
+                return upward ? up_middle[e] : down_middle[e];
+            }
+        }
+        std::cout << "the hierarchy has no edge from " << u << " to " << x << std::endl;
+        abort();
+    }
+    ~ContractionHierarchy() {
+        delete[] ranks;
+        delete up;
+        delete down;
+        delete[] up_middle;
+        delete[] down_middle;
+    }
+};
+
+/**
+  * Workspace of the queries on a ContractionHierarchy, to be reused from one query to the next; each thread needs
+  * its own. Each search keeps its distances and predecessors in a Vertex array, and only the entries touched by a
+  * query are reset by the next one, so a query costs time in the size of its searches rather than of the graph.
+  * The two searches alternate, each settling the vertex with the smallest distance of its queue, and a search
+  * stops once that distance reaches the length mu of the best path found so far; unlike the bidirectional
+  * Dijkstra's algorithm the two searches cannot stop together earlier, since each sees only part of the graph.
+  * A vertex is stalled, that is settled without relaxing its edges, when an edge from a vertex of higher rank
+  * shows that the search reached it through a path that is not the shortest one: on road-like graphs this
+  * prunes most of the upward search space. The path is unpacked by replacing each shortcut by its two halves.
+  */
+class HierarchyQuery {
+    const ContractionHierarchy& ch;  // the hierarchy
+    Vertex* sides[2];  // distance and predecessor of each vertex in the forward and in the backward search
+    int* touched;  // the vertices reached by the current query
+    std::size_t num_touched;  // number of vertices in 'touched'
+    BinaryHeap<SearchEntry, CompareEntries> heaps[2];  // the queues of the two searches
+    VertexList coarse;  // the path of the query, with shortcuts
+    VertexList stack;  // the pairs of vertices still to be unpacked
+
+    // set the distance of 'v' in search 'side' to 'd' through 'pred', and push it
+    void reach(const int side, const int v, const int d, const int pred) {
+        if (sides[0][v].d == INT_MAX && sides[1][v].d == INT_MAX) {
+            touched[num_touched++] = v;
+        }
+        sides[side][v].d = d;
+        sides[side][v].pred = pred;
+        heaps[side].push(SearchEntry{d, v});
+    }
+    // settle the next vertex of search 'side', lowering 'mu' if the other search has reached it too
+    void step(const int side, long long& mu, int& meeting, std::size_t& settled) {
+        const SearchEntry e{heaps[side].pop()};
+        Vertex* mine{sides[side]};
+        if (e.d > mine[e.v].d) {
+            return;
+        }
+        ++settled;
+        const int other{sides[1 - side][e.v].d};
+        if (other != INT_MAX && static_cast<long long>(e.d) + other < mu) {
+            mu = static_cast<long long>(e.d) + other;
+            meeting = e.v;
+        }
+        // stall-on-demand: the edges of the other graph at v come from vertices of higher rank
+        const CSRGraph& reverse = ch.graph(side == 0);
+        for (std::size_t i=reverse.offsets[e.v]; i < reverse.offsets[e.v + 1]; ++i) {
+            const int x{reverse.targets[i]};
+            if (mine[x].d != INT_MAX && static_cast<long long>(mine[x].d) + reverse.weights[i] < e.d) {
+                return;
+            }
+        }
+        const CSRGraph& g = ch.graph(side == 1);
+        for (std::size_t i=g.offsets[e.v]; i < g.offsets[e.v + 1]; ++i) {
+            const int x{g.targets[i]};
+            const long long d{static_cast<long long>(e.d) + g.weights[i]};
+            if (d < mine[x].d) {
+                reach(side, x, static_cast<int>(d), e.v);
+            }
+        }
+    }
+    // append to 'path' the vertices after 'u' of the path in the original graph that the edge u -> x stands for
+    void unpack(const int u, const int x, ShortestPath& path) {
+        stack.size = 0;
+        stack.push(u);
+        stack.push(x);
+        while (stack.size > 0) {
+            const int b{stack.items[--stack.size]};
+            const int a{stack.items[--stack.size]};
+            const int m{ch.middle(a, b)};
+            if (m == -1) {
+                path.push(b);
+            }
+            else {
+                // a -> m is unpacked first, so it goes on top
+                stack.push(m);
+                stack.push(b);
+                stack.push(a);
+                stack.push(m);
+            }
+        }
+    }
+
+  public:
+    explicit HierarchyQuery(const ContractionHierarchy& hierarchy) :
+        ch{hierarchy}, sides{new Vertex[hierarchy.size()], new Vertex[hierarchy.size()]}, touched{new int[hierarchy.size()]},
+        num_touched{0}, heaps{}, coarse{}, stack{} {
+        for (std::size_t v=0; v < ch.size(); ++v) {
+            sides[0][v] = Vertex{static_cast<int>(v)};
+            sides[1][v] = Vertex{static_cast<int>(v)};
+        }
+    }
+    HierarchyQuery(const HierarchyQuery&) = delete;
+    HierarchyQuery& operator=(const HierarchyQuery&) = delete;
+    // find a shortest path from 's' to 't' and store it in 'path'; returns its length, INT_MAX if 't' cannot be
+    // reached
+    int query(const int s, const int t, ShortestPath& path) {
+        for (std::size_t i=0; i < num_touched; ++i) {
+            sides[0][touched[i]].d = sides[1][touched[i]].d = INT_MAX;
+            sides[0][touched[i]].pred = sides[1][touched[i]].pred = -1;
+        }
+        num_touched = 0;
+        heaps[0].size = 0;
+        heaps[1].size = 0;
+        path.reset(0);
+        reach(0, s, 0, -1);
+        reach(1, t, 0, -1);
+        long long mu{LLONG_MAX};
+        int meeting{-1};
+        for (int side=0; ; side = 1 - side) {
+            const bool forward{!heaps[0].is_empty() && heaps[0].top().d < mu};
+            const bool backward{!heaps[1].is_empty() && heaps[1].top().d < mu};
+            if (!forward && !backward) {
+                break;
+            }
+            side = (forward && backward) ? side : (forward ? 0 : 1);
+            step(side, mu, meeting, path.settled);
+        }
+        if (meeting == -1) {
+            return path.distance;
+        }
+        path.distance = static_cast<int>(mu);
+        // the path with shortcuts: up from s to the meeting vertex, then down to t
+        coarse.size = 0;
+        for (int v=meeting; v != -1; v = sides[0][v].pred) {
+            coarse.push(v);
+        }
+        for (std::size_t i=0, j=coarse.size - 1; i < j; ++i, --j) {
+            const int tmp{coarse.items[i]};
+            coarse.items[i] = coarse.items[j];
+            coarse.items[j] = tmp;
+        }
+        for (int v=sides[1][meeting].pred; v != -1; v = sides[1][v].pred) {
+            coarse.push(v);
+        }
+        path.push(s);
+        for (std::size_t i=0; i + 1 < coarse.size; ++i) {
+            unpack(coarse.items[i], coarse.items[i + 1], path);
+        }
+        return path.distance;
+    }
+    ~HierarchyQuery() {
+        delete[] sides[0];
+        delete[] sides[1];
+        delete[] touched;
+    }
+};
+
+#endif  // __CONTRACTION_HIERARCHY__
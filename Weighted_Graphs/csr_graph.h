@@ -0,0 +1,150 @@
+#ifndef __CSR_GRAPH__
+#define __CSR_GRAPH__
+
+/**
+  * This header file contains the compressed sparse row (CSR) representation of a weighted directed graph,
+  * to be used by Dijkstra's algorithm on graphs too large and too sparse for an adjacency matrix
+  */
+
+#include <iostream>
+#include <cstdlib>
+
+/**
+  * Weighted directed edge from 'source' to 'target', as read from an edge list
+  */
+struct Edge {
+    int source;  // index of the tail vertex
+    int target;  // index of the head vertex
+    int weight;  // weight of the edge, non-negative
+};
+
+/**
+  * Graph in compressed sparse row form. The edges leaving vertex u are stored contiguously, from position
+  * offsets[u] (included) to offsets[u+1] (excluded) of the arrays 'targets' and 'weights', so a vertex of
+  * degree k has its neighbors in k consecutive slots and the whole graph takes O(n + m) space. Visiting the
+  * neighbors of every vertex costs O(n + m) instead of the Θ(n²) of a row scan of the adjacency matrix,
+  * which makes Dijkstra's algorithm O((n + m) log n) with a heap.
+  * The graph owns its arrays, unless it has been built over arrays owned by someone else, like the memory
+  * mapping of a snapshot (see graph_io.h).
+  */
+struct CSRGraph {
+    std::size_t n;  // number of vertices
+    std::size_t m;  // number of edges
+    std::size_t* offsets;  // offsets[u] is the position of the first edge leaving u; offsets[n] == m
+    int* targets;  // head of each edge
+    int* weights;  // weight of each edge
+    bool owned;  // whether the arrays have been allocated by the graph, and must be released by it
+
+    // Constructor, builds the graph with 'num_vertices' vertices and the 'num_edges' edges of 'edges', in any
+    // order. The edges are bucketed by source with a counting sort in O(n + m), keeping their relative order.
+    // An edge with an endpoint out of range or a negative weight aborts the program
+    CSRGraph(const Edge* edges, const std::size_t num_edges, const std::size_t num_vertices) :
+        n{num_vertices}, m{num_edges}, offsets{new std::size_t[num_vertices + 1]}, targets{new int[num_edges]}, weights{new int[num_edges]}, owned{true} {
+        for (std::size_t u=0; u <= n; ++u) {
+            offsets[u] = 0;
+        }
+        for (std::size_t e=0; e < m; ++e) {
+            if (edges[e].source < 0 || static_cast<std::size_t>(edges[e].source) >= n
+                || edges[e].target < 0 || static_cast<std::size_t>(edges[e].target) >= n) {
+                std::cout << "edge " << e << " has an endpoint out of range" << std::endl;
+                abort();
+            }
+            // Dijkstra's algorithm is not intended for graphs with negative weights
+            if (edges[e].weight < 0) {
+                std::cout << "edge " << e << " has a negative weight" << std::endl;
+                abort();
+            }
+            ++offsets[edges[e].source + 1];
+        }
+        // prefix sums of the degrees: offsets[u] is now the first position of the edges of u
+        for (std::size_t u=0; u < n; ++u) {
+            offsets[u + 1] += offsets[u];
+        }
+        // place each edge at the next free position of its source, using a copy of the offsets as cursors
+        std::size_t* next{new std::size_t[n + 1]};
+        for (std::size_t u=0; u <= n; ++u) {
+            next[u] = offsets[u];
+        }
+        for (std::size_t e=0; e < m; ++e) {
+            const std::size_t i{next[edges[e].source]++};
+            targets[i] = edges[e].target;
+            weights[i] = edges[e].weight;
+        }
+        delete[] next;
+    }
+    // Constructor from the adjacency matrix 'matrix' of 'num_vertices' vertices, where -1 stands for no edge
+    template<std::size_t M>
+    CSRGraph(int matrix[][M], const std::size_t num_vertices) :
+        n{num_vertices}, m{0}, offsets{new std::size_t[num_vertices + 1]}, targets{nullptr}, weights{nullptr}, owned{true} {
+        for (std::size_t u=0; u < n; ++u) {
+            for (std::size_t v=0; v < n; ++v) {
+                m += (matrix[u][v] != -1);
+            }
+        }
+        targets = new int[m];
+        weights = new int[m];
+        std::size_t i{0};
+        for (std::size_t u=0; u < n; ++u) {
+            offsets[u] = i;
+            for (std::size_t v=0; v < n; ++v) {
+                if (matrix[u][v] != -1) {
+                    targets[i] = v;
+                    weights[i] = matrix[u][v];
+                    ++i;
+                }
+            }
+        }
+        offsets[n] = m;
+    }
+    // Constructor over the arrays of a graph with 'num_vertices' vertices and 'num_edges' edges, already in CSR form
+    // and owned by someone else: they are neither copied nor released, and must outlive the graph
+    CSRGraph(const std::size_t num_vertices, const std::size_t num_edges, std::size_t* offset_array, int* target_array, int* weight_array) noexcept :
+        n{num_vertices}, m{num_edges}, offsets{offset_array}, targets{target_array}, weights{weight_array}, owned{false} {}
+    CSRGraph(const CSRGraph&) = delete;
+    CSRGraph& operator=(const CSRGraph&) = delete;
+    // number of edges leaving vertex u
+    std::size_t degree(const std::size_t u) const noexcept {
+        return offsets[u + 1] - offsets[u];
+    }
+    // the reverse graph, with every edge u -> v turned into v -> u with the same weight, built with a counting sort in
+    // O(n + m); the edges entering each vertex keep the order of their sources. To be deleted by the caller
+    CSRGraph* reverse() const {
+        std::size_t* reverse_offsets{new std::size_t[n + 1]};
+        int* reverse_targets{new int[m]};
+        int* reverse_weights{new int[m]};
+        for (std::size_t v=0; v <= n; ++v) {
+            reverse_offsets[v] = 0;
+        }
+        for (std::size_t e=0; e < m; ++e) {
+            ++reverse_offsets[targets[e] + 1];
+        }
+        for (std::size_t v=0; v < n; ++v) {
+            reverse_offsets[v + 1] += reverse_offsets[v];
+        }
+        std::size_t* next{new std::size_t[n + 1]};
+        for (std::size_t v=0; v <= n; ++v) {
+            next[v] = reverse_offsets[v];
+        }
+        for (std::size_t u=0; u < n; ++u) {
+            for (std::size_t e=offsets[u]; e < offsets[u + 1]; ++e) {
+                const std::size_t i{next[targets[e]]++};
+                reverse_targets[i] = u;
+                reverse_weights[i] = weights[e];
+            }
+        }
+        delete[] next;
+        CSRGraph* graph{new CSRGraph{n, m, reverse_offsets, reverse_targets, reverse_weights}};
+        graph->owned = true;
+        return graph;
+    }
+    // Destructor
+    ~CSRGraph() {
+        if (owned) {
+            delete[] offsets;
+            delete[] targets;
+            delete[] weights;
+        }
+    }
+};
+
+#endif  // __CSR_GRAPH__
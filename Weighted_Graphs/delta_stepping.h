@@ -0,0 +1,234 @@
+#ifndef __DELTA_STEPPING__
+#define __DELTA_STEPPING__
+
+/**
+  * This header file contains the delta-stepping algorithm of Meyer and Sanders, a parallel single-source shortest
+  * paths algorithm for graphs in CSR form, to be used instead of Dijkstra's algorithm on large graphs
+  */
+
+#include <cstdint>
+#include <climits>
+#include <atomic>
+
+#include "graph_utilities.h"
+#include "csr_graph.h"
+
+/**
+  * State of a run of delta-stepping. The tentative distances are kept in buckets of width 'delta': bucket i holds
+  * the vertices whose distance lies in [i * delta, (i + 1) * delta). The buckets are processed in order, and the
+  * vertices of the current bucket all at the same time. Edges are split into light (weight <= delta) and heavy
+  * ones: relaxing a light edge may put a vertex back into the current bucket, so the light edges of the bucket are
+  * relaxed in rounds until it stays empty, while the heavy edges of the vertices removed from it are relaxed only
+  * once, at the end. Each round is split among the threads, which synchronize at a barrier between rounds.
+  * The distance and the predecessor of each vertex are packed in a single 64-bit word, the distance in the high
+  * half, which is lowered with an atomic compare-and-swap: the word then always holds a consistent pair. It is only
+  * replaced when the distance strictly decreases, so a vertex is never queued again for an equal distance, and as in
+  * the generic labeling algorithm the predecessors form a tree even with zero-weight edges. Since a tentative
+  * distance exceeds the one of the current bucket by at most the largest weight, only max_weight / delta + 2 buckets
+  * are needed at any time, used cyclically. A vertex can be in more than one bucket: the copies in buckets that no
+  * longer match its distance are skipped.
+  */
+struct DeltaStepping {
+    const CSRGraph& graph;  // the graph
+    std::size_t threads;  // number of threads
+    long long delta;  // width of the buckets
+    std::size_t num_buckets;  // number of buckets, used cyclically
+    std::uint64_t* best;  // best[v] holds the distance of v in the high 32 bits and its predecessor in the low 32
+    long long* queued;  // queued[v] is the bucket v has last been added to and not yet removed from, -1 if none
+    VertexList* buckets;  // the buckets, bucket i is buckets[i % num_buckets]
+    VertexList* added;  // added[t] are the vertices thread t added to some bucket since the last collect
+    VertexList* added_to;  // added_to[t][i] is the bucket of added[t][i], relative to the current one
+    VertexList* removed;  // removed[t] are the vertices thread t removed from the current bucket, for the heavy edges
+    int* frontier;  // the vertices of the current bucket, being processed
+    std::size_t frontier_size;  // number of vertices in 'frontier'
+    std::size_t frontier_capacity;  // length of 'frontier'
+    std::atomic<std::size_t> next_chunk;  // first vertex of the frontier not yet taken by any thread
+    int source;  // the source, which never gets a predecessor
+    long long current;  // index of the current bucket
+    bool done;  // whether all the buckets are empty
+    Barrier barrier;  // synchronizes the threads between rounds
+
+    static const std::size_t CHUNK = 256;  // vertices of the frontier taken by a thread at a time
+    static const std::uint64_t UNREACHED = (static_cast<std::uint64_t>(INT_MAX) << 32) | 0xFFFFFFFFu;
+
+    DeltaStepping(const CSRGraph& g, const int s, const std::size_t num_threads, const long long width, const int max_weight) :
+        graph{g}, threads{num_threads}, delta{width}, num_buckets{static_cast<std::size_t>(max_weight / width + 2)},
+        best{new std::uint64_t[g.n]}, queued{new long long[g.n]}, buckets{new VertexList[num_buckets]},
+        added{new VertexList[num_threads]}, added_to{new VertexList[num_threads]}, removed{new VertexList[num_threads]},
+        frontier{nullptr}, frontier_size{0}, frontier_capacity{0}, next_chunk{0}, source{s}, current{0}, done{false}, barrier{num_threads} {
+        for (std::size_t v=0; v < graph.n; ++v) {
+            best[v] = UNREACHED;
+            queued[v] = -1;
+        }
+        // the source starts alone in bucket 0, at distance 0 with no predecessor
+        best[source] = 0xFFFFFFFFu;
+        queued[source] = 0;
+        buckets[0].push(source);
+    }
+    DeltaStepping(const DeltaStepping&) = delete;
+    DeltaStepping& operator=(const DeltaStepping&) = delete;
+    ~DeltaStepping() {
+        delete[] best;
+        delete[] queued;
+        delete[] buckets;
+        delete[] added;
+        delete[] added_to;
+        delete[] removed;
+        delete[] frontier;
+    }
+
+    static long long distance(const std::uint64_t word) noexcept {
+        return static_cast<long long>(word >> 32);
+    }
+    // lower the distance of v to 'd' through u, if it is an improvement; thread t then adds v to the bucket of 'd'.
+    // The update of 'best' and the check of 'queued' are sequentially consistent, and so are their counterparts in
+    // light_round: either the thread removing v from the current bucket sees the new distance, or this one sees
+    // that v has been removed and adds it again
+    void relax(const int u, const int v, const long long d, const std::size_t t) {
+        if (d >= INT_MAX || v == source) {
+            return;
+        }
+        const std::uint64_t word{(static_cast<std::uint64_t>(d) << 32) | static_cast<std::uint32_t>(u)};
+        std::uint64_t old{__atomic_load_n(&best[v], __ATOMIC_RELAXED)};
+        while (d < distance(old)) {
+            if (__atomic_compare_exchange_n(&best[v], &old, word, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+                // add v to its new bucket, unless it is already waiting there
+                const long long b{d / delta};
+                if (__atomic_exchange_n(&queued[v], b, __ATOMIC_SEQ_CST) != b) {
+                    added[t].push(v);
+                    added_to[t].push(static_cast<int>(b - current));
+                }
+                return;
+            }
+        }
+    }
+    // move the vertices added by all the threads to their buckets. Called by a single thread
+    void collect() {
+        for (std::size_t t=0; t < threads; ++t) {
+            for (std::size_t i=0; i < added[t].size; ++i) {
+                buckets[(current + added_to[t].items[i]) % num_buckets].push(added[t].items[i]);
+            }
+            added[t].size = 0;
+            added_to[t].size = 0;
+        }
+    }
+    // move the current bucket to the frontier, emptying it. Called by a single thread
+    void take_current() {
+        VertexList& bucket = buckets[current % num_buckets];
+        if (bucket.size > frontier_capacity) {
+            delete[] frontier;
+            frontier_capacity = bucket.capacity;
+            frontier = new int[frontier_capacity];
+        }
+        for (std::size_t i=0; i < bucket.size; ++i) {
+            frontier[i] = bucket.items[i];
+        }
+        frontier_size = bucket.size;
+        bucket.size = 0;
+        next_chunk.store(0, std::memory_order_relaxed);
+    }
+    // advance 'current' to the first non-empty bucket, or set 'done'. Called by a single thread
+    void next_bucket() {
+        for (std::size_t k=0; k < num_buckets; ++k, ++current) {
+            if (buckets[current % num_buckets].size > 0) {
+                return;
+            }
+        }
+        done = true;
+    }
+    // relax the light edges of the vertices of the frontier, in chunks taken from a shared counter
+    void light_round(const std::size_t t) {
+        for (std::size_t lo=next_chunk.fetch_add(CHUNK); lo < frontier_size; lo = next_chunk.fetch_add(CHUNK)) {
+            const std::size_t hi{lo + CHUNK < frontier_size ? lo + CHUNK : frontier_size};
+            for (std::size_t i=lo; i < hi; ++i) {
+                const int u{frontier[i]};
+                __atomic_store_n(&queued[u], -1, __ATOMIC_SEQ_CST);
+                const long long du{distance(__atomic_load_n(&best[u], __ATOMIC_SEQ_CST))};
+                // a copy left in an older bucket
+                if (du / delta != current) {
+                    continue;
+                }
+                removed[t].push(u);
+                for (std::size_t e=graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+                    if (graph.weights[e] <= delta) {
+                        relax(u, graph.targets[e], du + graph.weights[e], t);
+                    }
+                }
+            }
+        }
+    }
+    // relax the heavy edges of the vertices thread t removed from the current bucket
+    void heavy_round(const std::size_t t) {
+        for (std::size_t i=0; i < removed[t].size; ++i) {
+            const int u{removed[t].items[i]};
+            const long long du{distance(__atomic_load_n(&best[u], __ATOMIC_RELAXED))};
+            for (std::size_t e=graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+                if (graph.weights[e] > delta) {
+                    relax(u, graph.targets[e], du + graph.weights[e], t);
+                }
+            }
+        }
+        removed[t].size = 0;
+    }
+    // the loop run by each thread; thread 0 also does the bookkeeping between rounds
+    void run(const std::size_t t) {
+        while (true) {
+            if (t == 0) {
+                next_bucket();
+                if (!done) {
+                    take_current();
+                }
+            }
+            barrier.wait();
+            if (done) {
+                return;
+            }
+            // light rounds, until the current bucket stays empty
+            while (frontier_size > 0) {
+                light_round(t);
+                barrier.wait();
+                if (t == 0) {
+                    collect();
+                    take_current();
+                }
+                barrier.wait();
+            }
+            heavy_round(t);
+            barrier.wait();
+            if (t == 0) {
+                collect();
+            }
+        }
+    }
+};
+
+/**
+  * Compute the shortest paths from 's' in the CSR 'graph' with delta-stepping, on 'threads' threads, and store the
+  * distances and the predecessors in the graph.n vertices of 'V', like dijkstra does; all the vertices end up off the
+  * queue. When a vertex can be reached through several predecessors at the same distance, the first relaxation to
+  * reach that distance sets the predecessor, so the tree may differ from the one of dijkstra, but it is always a
+  * shortest-paths tree rooted at 's'. The width 'delta' of the buckets is tuned automatically if it is 0 (or less):
+  * following Meyer and Sanders, it is set to the largest weight divided by the average degree. A wider bucket means
+  * fewer rounds, hence fewer barriers, but more vertices relaxed before their distance is final
+  */
+inline void delta_stepping(const CSRGraph& graph, Vertex V[], Vertex& s, std::size_t threads=default_threads(), long long delta=0) {
+    threads = (threads > 0) ? threads : 1;
+    int max_weight{0};
+    for (std::size_t e=0; e < graph.m; ++e) {
+        max_weight = (graph.weights[e] > max_weight) ? graph.weights[e] : max_weight;
+    }
+    if (delta <= 0) {
+        delta = (graph.m > 0) ? static_cast<long long>(max_weight) * graph.n / graph.m : 1;
+        delta = (delta > 0) ? delta : 1;
+    }
+    DeltaStepping state{graph, s.index, threads, delta, max_weight};
+    run_threads(threads, [&state](const std::size_t t) {state.run(t);});
+    for (std::size_t v=0; v < graph.n; ++v) {
+        V[v].d = static_cast<int>(state.best[v] >> 32);
+        const std::uint32_t pred{static_cast<std::uint32_t>(state.best[v])};
+        V[v].pred = (pred == 0xFFFFFFFFu) ? -1 : static_cast<int>(pred);
+        V[v].on_queue = false;
+    }
+}
+
+#endif  // __DELTA_STEPPING__
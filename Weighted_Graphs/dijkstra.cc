@@ -1,20 +1,36 @@
 #include <iostream>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
 
 #include "graph_utilities.h"
+#include "csr_graph.h"
+#include "graph_io.h"
+#include "delta_stepping.h"
+#include "point_to_point.h"
+#include "heuristics.h"
+#include "contraction_hierarchy.h"
+#include "dijkstra_workspace.h"
+#include "distance_table.h"
 #include "heap.h"
+#include "pairing_heap.h"
+#include "fibonacci_heap.h"
 
 #define N 6  // number of vertices of the graph
+#define MAX_WEIGHT 100  // maximum weight of the edges of the generated graphs
+#define AVERAGE_DEGREE 4  // average number of edges leaving a vertex of the generated sparse graphs
 
 
 /**
   * Run Dijkstra's SSSP algorithm on a graph, given an array of Vertex instances 'V', their number 'n' and a reference to the source vertex 's'.
   * The representation of the graph is given by an adjacency matrix. Notice the template defines the queue data structure to use, which will be
   * (at least in our tests) either an array-based implementation of the queue data structure (the class 'Queue' coming from the graph_utilities.h
-  * header file), or a BinaryHeap data structure, implemented in the heap.h header for a previous assignment.
+  * header file), or a BinaryHeap data structure, implemented in the heap.h header for a previous assignment. The queue is indexed by
+  * vertex: extract_min returns the index of a vertex, and decrease takes the index of the vertex whose distance has just decreased.
+  * The width 'M' of the adjacency matrix is deduced from the argument, so graphs of any size can be passed.
   */
-template<class Q>
-void dijkstra(int graph[][N], Vertex V[], const std::size_t n, Vertex& s) {
+template<class Q, std::size_t M>
+void dijkstra(int graph[][M], Vertex V[], const std::size_t n, Vertex& s) {
     s.d = 0;  // set source distance to 0
     Q q{V, n};  // build queue from the vertices
     // iterate until while there are still nodes to finalize
@@ -22,6 +38,10 @@ void dijkstra(int graph[][N], Vertex V[], const std::size_t n, Vertex& s) {
         // while the queue is not empty, extract the minimum and mark it as no longer in queue
         Vertex& u = V[q.extract_min()];
         u.on_queue = false;
+        // a vertex at infinite distance is unreachable, and so are all the vertices left in the queue
+        if (u.d == INT_MAX) {
+            continue;
+        }
         // then iterate over the neighbors (a row in the adjacency matrix) and perform the relaxation step, if necessary
         for (std::size_t i=0; i < n; ++i) {
             int w = graph[u.index][i];  // the weight of the edge
@@ -31,17 +51,814 @@ void dijkstra(int graph[][N], Vertex V[], const std::size_t n, Vertex& s) {
                 // perform the relaxation step of Dijkstra's algorithm. Check if the candidate distance of v is greater than
                 // its parent's distance plus the weight of the edge
                 if (u.d + w < v.d) {
-                    q.decrease(v.index, u.d + w);  // update the queue
                     v.d = u.d + w;  // update v's distance
                     v.pred = u.index;  // set u to be the predecessor in the shortes-path tree
+                    q.decrease(v.index, v);  // update the queue
                 }
             }
         }
     }
 }
 
+/**
+  * Run Dijkstra's SSSP algorithm on a graph in compressed sparse row form (see csr_graph.h), given an array of graph.n
+  * Vertex instances 'V' and a reference to the source vertex 's'. Same as above, except that the relaxation step only
+  * visits the edges actually leaving u, so the algorithm is O((n + m) log n) with a heap instead of Θ(n²).
+  */
+template<class Q>
+void dijkstra(const CSRGraph& graph, Vertex V[], Vertex& s) {
+    s.d = 0;  // set source distance to 0
+    Q q{V, graph.n};  // build queue from the vertices
+    while (!q.is_empty()) {
+        Vertex& u = V[q.extract_min()];
+        u.on_queue = false;
+        if (u.d == INT_MAX) {
+            continue;
+        }
+        // iterate over the edges leaving u, which are contiguous
+        for (std::size_t e=graph.offsets[u.index]; e < graph.offsets[u.index + 1]; ++e) {
+            Vertex& v = V[graph.targets[e]];
+            if (v.on_queue && u.d + graph.weights[e] < v.d) {
+                v.d = u.d + graph.weights[e];
+                v.pred = u.index;
+                q.decrease(v.index, v);
+            }
+        }
+    }
+}
+
+/**
+  * Same as above with the vertices in a VertexStore 'V' of graph.n vertices (see graph_utilities.h), from the source
+  * 's'. The queue 'Q' is built from the store, and is given the new distance of a vertex when it decreases
+  */
+template<class Q>
+void dijkstra(const CSRGraph& graph, VertexStore& V, const int s) {
+    V.d[s] = 0;
+    Q q{V};
+    while (!q.is_empty()) {
+        const int u = q.extract_min();
+        V.settle(u);
+        const int du{V.d[u]};
+        if (du == INT_MAX) {
+            continue;
+        }
+        for (std::size_t e=graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+            const int v{graph.targets[e]};
+            if (du + graph.weights[e] < V.d[v] && V.on_queue(v)) {
+                V.d[v] = du + graph.weights[e];
+                V.pred[v] = u;
+                q.decrease(v, V.d[v]);
+            }
+        }
+    }
+}
+
+
+/**
+  * Fill the adjacency matrix 'graph' of a random directed graph with M vertices, where each edge is present
+  * with probability 'density' percent and has a weight between 1 and MAX_WEIGHT
+  */
+template<std::size_t M>
+void generate_graph(int graph[][M], const int density) {
+    for (std::size_t i=0; i < M; ++i) {
+        for (std::size_t j=0; j < M; ++j) {
+            graph[i][j] = (i != j && rand()%100 < density) ? rand()%MAX_WEIGHT + 1 : -1;
+        }
+    }
+}
+
+/**
+  * Run Dijkstra's algorithm with queue 'Q' on 'graph' from vertex 0, after resetting the vertices in 'V'.
+  * Returns the elapsed time in nanoseconds
+  */
+template<class Q, std::size_t M>
+long long time_dijkstra(int graph[][M], Vertex V[]) {
+    for (std::size_t i=0; i < M; ++i) {
+        V[i] = Vertex{static_cast<int>(i)};
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    dijkstra<Q>(graph, V, M, V[0]);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+/**
+  * Run Dijkstra's algorithm with queue 'Q' on the CSR 'graph' from vertex 0, after resetting the vertices in 'V'.
+  * Returns the elapsed time in nanoseconds
+  */
+template<class Q>
+long long time_dijkstra(const CSRGraph& graph, Vertex V[]) {
+    for (std::size_t i=0; i < graph.n; ++i) {
+        V[i] = Vertex{static_cast<int>(i)};
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    dijkstra<Q>(graph, V, V[0]);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+/**
+  * Run Dijkstra's algorithm with queue 'Q' on the CSR 'graph' from vertex 0, after resetting the store 'V'.
+  * Returns the elapsed time in nanoseconds
+  */
+template<class Q>
+long long time_dijkstra(const CSRGraph& graph, VertexStore& V) {
+    V.reset();
+    auto start = std::chrono::high_resolution_clock::now();
+    dijkstra<Q>(graph, V, 0);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+/**
+  * Fill 'edges' with the 'm' edges of a random directed graph with 'n' vertices, with weights between 1 and MAX_WEIGHT
+  */
+void generate_edges(Edge* edges, const std::size_t m, const std::size_t n) {
+    for (std::size_t e=0; e < m; ++e) {
+        edges[e] = Edge{static_cast<int>(rand() % n), static_cast<int>(rand() % n), rand() % MAX_WEIGHT + 1};
+    }
+}
+
+/**
+  * Compare the queue engines on a generated graph with M vertices and the given 'density'. The distances
+  * computed with the array-based Queue are taken as reference for the other engines
+  */
+template<std::size_t M>
+void benchmark_queues(const int density) {
+    int (*graph)[M] = new int[M][M];  // too large for the stack
+    generate_graph(graph, density);
+    Vertex* V = new Vertex[M];
+    int* reference = new int[M];
+    std::cout << "Size: " << M << " Density: " << density << "%" << std::endl;
+    std::cout << "Array: " << time_dijkstra<Queue>(graph, V) << std::endl;
+    for (std::size_t i=0; i < M; ++i) {
+        reference[i] = V[i].d;
+    }
+    bool correct{true};
+    std::cout << "BinaryHeap: " << time_dijkstra<BinaryHeap<Vertex, CompareVertex, VertexHandle>>(graph, V) << std::endl;
+    for (std::size_t i=0; i < M; ++i) correct = correct && V[i].d == reference[i];
+    std::cout << "PairingHeap: " << time_dijkstra<PairingHeap<Vertex, CompareVertex, VertexHandle>>(graph, V) << std::endl;
+    for (std::size_t i=0; i < M; ++i) correct = correct && V[i].d == reference[i];
+    std::cout << "FibonacciHeap: " << time_dijkstra<FibonacciHeap<Vertex, CompareVertex, VertexHandle>>(graph, V) << std::endl;
+    for (std::size_t i=0; i < M; ++i) correct = correct && V[i].d == reference[i];
+    std::cout << "RadixHeap: " << time_dijkstra<RadixHeap>(graph, V) << std::endl;
+    for (std::size_t i=0; i < M; ++i) correct = correct && V[i].d == reference[i];
+    std::cout << "DialQueue: " << time_dijkstra<DialQueue>(graph, V) << std::endl;
+    for (std::size_t i=0; i < M; ++i) correct = correct && V[i].d == reference[i];
+    {
+        CSRGraph csr{graph, M};
+        std::cout << "BinaryHeap on CSR: " << time_dijkstra<BinaryHeap<Vertex, CompareVertex, VertexHandle>>(csr, V) << std::endl;
+        for (std::size_t i=0; i < M; ++i) correct = correct && V[i].d == reference[i];
+    }
+    std::cout << (correct ? "distances match" : "DISTANCES DIFFER") << std::endl;
+    delete[] reference;
+    delete[] V;
+    delete[] graph;
+}
+
+/**
+  * Compare the heap-based engines on a generated sparse graph in CSR form with 'n' vertices and AVERAGE_DEGREE * n
+  * edges, far too large for an adjacency matrix. The distances computed with the BinaryHeap are taken as reference
+  */
+void benchmark_sparse(const std::size_t n) {
+    const std::size_t m{AVERAGE_DEGREE * n};
+    Edge* edges = new Edge[m];
+    generate_edges(edges, m, n);
+    auto start = std::chrono::high_resolution_clock::now();
+    CSRGraph graph{edges, m, n};
+    auto end = std::chrono::high_resolution_clock::now();
+    delete[] edges;
+    Vertex* V = new Vertex[n];
+    int* reference = new int[n];
+    std::cout << "Vertices: " << n << " Edges: " << m << std::endl;
+    std::cout << "CSR build: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << std::endl;
+    std::cout << "BinaryHeap: " << time_dijkstra<BinaryHeap<Vertex, CompareVertex, VertexHandle>>(graph, V) << std::endl;
+    for (std::size_t i=0; i < n; ++i) {
+        reference[i] = V[i].d;
+    }
+    bool correct{true};
+    std::cout << "4-ary heap: " << time_dijkstra<DaryHeap<Vertex, CompareVertex, 4, VertexHandle>>(graph, V) << std::endl;
+    for (std::size_t i=0; i < n; ++i) correct = correct && V[i].d == reference[i];
+    std::cout << "PairingHeap: " << time_dijkstra<PairingHeap<Vertex, CompareVertex, VertexHandle>>(graph, V) << std::endl;
+    for (std::size_t i=0; i < n; ++i) correct = correct && V[i].d == reference[i];
+    std::cout << "FibonacciHeap: " << time_dijkstra<FibonacciHeap<Vertex, CompareVertex, VertexHandle>>(graph, V) << std::endl;
+    for (std::size_t i=0; i < n; ++i) correct = correct && V[i].d == reference[i];
+    std::cout << "RadixHeap: " << time_dijkstra<RadixHeap>(graph, V) << std::endl;
+    for (std::size_t i=0; i < n; ++i) correct = correct && V[i].d == reference[i];
+    std::cout << "DialQueue: " << time_dijkstra<DialQueue>(graph, V) << std::endl;
+    for (std::size_t i=0; i < n; ++i) correct = correct && V[i].d == reference[i];
+    {
+        // the same queues on the vertices laid out as a structure of arrays
+        VertexStore store{n};
+        std::cout << "RadixHeap on VertexStore: " << time_dijkstra<RadixHeap>(graph, store) << std::endl;
+        for (std::size_t i=0; i < n; ++i) correct = correct && store.d[i] == reference[i];
+        std::cout << "DialQueue on VertexStore: " << time_dijkstra<DialQueue>(graph, store) << std::endl;
+        for (std::size_t i=0; i < n; ++i) correct = correct && store.d[i] == reference[i];
+    }
+    std::cout << (correct ? "distances match" : "DISTANCES DIFFER") << std::endl;
+    delete[] reference;
+    delete[] V;
+}
+
+/**
+  * Whether the distances in 'V' match 'reference', the predecessor of each reached vertex other than the source
+  * is joined to it by an edge of 'graph' that is tight, that is whose weight is the difference of the distances,
+  * and the predecessors form no cycle, so that following them from any vertex ends at the source
+  */
+bool check_tree(const CSRGraph& graph, const Vertex V[], const int reference[]) {
+    for (std::size_t v=0; v < graph.n; ++v) {
+        if (V[v].d != reference[v]) {
+            return false;
+        }
+        if (V[v].pred == -1) {
+            continue;
+        }
+        const int u{V[v].pred};
+        bool tight{false};
+        for (std::size_t e=graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+            tight = tight || (graph.targets[e] == static_cast<int>(v) && V[u].d + graph.weights[e] == V[v].d);
+        }
+        if (!tight) {
+            return false;
+        }
+    }
+    // walk up from each vertex until a vertex already known to lead to a root; 1 marks the current walk
+    char* state = new char[graph.n];
+    for (std::size_t v=0; v < graph.n; ++v) {
+        state[v] = 0;
+    }
+    bool acyclic{true};
+    for (std::size_t v=0; v < graph.n && acyclic; ++v) {
+        int u{static_cast<int>(v)};
+        while (u != -1 && state[u] == 0) {
+            state[u] = 1;
+            u = V[u].pred;
+        }
+        acyclic = (u == -1 || state[u] == 2);
+        for (u = static_cast<int>(v); u != -1 && state[u] == 1; u = V[u].pred) {
+            state[u] = 2;
+        }
+    }
+    delete[] state;
+    return acyclic;
+}
+
+/**
+  * Run delta-stepping from vertex 0 of the CSR 'graph' on 'threads' threads, with buckets of width 'delta'
+  * (0 to tune it automatically), after resetting the vertices in 'V'. Returns the elapsed time in nanoseconds
+  */
+long long time_delta_stepping(const CSRGraph& graph, Vertex V[], const std::size_t threads, const long long delta) {
+    for (std::size_t i=0; i < graph.n; ++i) {
+        V[i] = Vertex{static_cast<int>(i)};
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    delta_stepping(graph, V, V[0], threads, delta);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+/**
+  * Compare delta-stepping with Dijkstra's algorithm on a generated sparse graph with 'n' vertices, for a few
+  * bucket widths and numbers of threads. The distances of Dijkstra's algorithm with a BinaryHeap are taken as
+  * reference, and the predecessors must form a shortest path tree
+  */
+void benchmark_delta_stepping(const std::size_t n) {
+    const std::size_t m{AVERAGE_DEGREE * n};
+    Edge* edges = new Edge[m];
+    generate_edges(edges, m, n);
+    CSRGraph graph{edges, m, n};
+    delete[] edges;
+    Vertex* V = new Vertex[n];
+    int* reference = new int[n];
+    std::cout << "Vertices: " << n << " Edges: " << m << std::endl;
+    std::cout << "BinaryHeap: " << time_dijkstra<BinaryHeap<Vertex, CompareVertex, VertexHandle>>(graph, V) << std::endl;
+    for (std::size_t i=0; i < n; ++i) {
+        reference[i] = V[i].d;
+    }
+    bool correct{true};
+    for (std::size_t threads : {1, 4}) {
+        for (long long delta : {0, 1, 10, 100}) {
+            const long long time{time_delta_stepping(graph, V, threads, delta)};
+            std::cout << "Delta-stepping, " << threads << " threads, delta ";
+            if (delta == 0) {
+                std::cout << "auto";
+            }
+            else {
+                std::cout << delta;
+            }
+            std::cout << ": " << time << std::endl;
+            correct = correct && check_tree(graph, V, reference);
+        }
+    }
+    // a quarter of the edges at weight 0, so that many vertices have several predecessors at the same distance
+    for (std::size_t e=0; e < m; e += 4) {
+        graph.weights[e] = 0;
+    }
+    time_dijkstra<BinaryHeap<Vertex, CompareVertex, VertexHandle>>(graph, V);
+    for (std::size_t i=0; i < n; ++i) {
+        reference[i] = V[i].d;
+    }
+    for (std::size_t threads : {1, 4}) {
+        std::cout << "Delta-stepping with zero weights, " << threads << " threads: " << time_delta_stepping(graph, V, threads, 0) << std::endl;
+        correct = correct && check_tree(graph, V, reference);
+    }
+    std::cout << (correct ? "distances match" : "DISTANCES DIFFER") << std::endl;
+    delete[] reference;
+    delete[] V;
+}
+
+/**
+  * Whether 'path' is a path from 's' to 't' along edges of 'graph' whose weights add up to its distance
+  */
+bool check_path(const CSRGraph& graph, const ShortestPath& path, const int s, const int t) {
+    if (path.distance == INT_MAX) {
+        return path.length == 0;
+    }
+    if (path.length == 0 || path.vertices[0] != s || path.vertices[path.length - 1] != t) {
+        return false;
+    }
+    long long length{0};
+    for (std::size_t i=0; i + 1 < path.length; ++i) {
+        const int u{path.vertices[i]};
+        int best{INT_MAX};  // the lightest edge from u to the next vertex
+        for (std::size_t e=graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+            if (graph.targets[e] == path.vertices[i + 1] && graph.weights[e] < best) {
+                best = graph.weights[e];
+            }
+        }
+        if (best == INT_MAX) {
+            return false;
+        }
+        length += best;
+    }
+    return length == path.distance;
+}
+
+/**
+  * Compare bidirectional Dijkstra with the full Dijkstra's algorithm on 'queries' random pairs of vertices of a
+  * generated sparse graph with 'n' vertices. Prints the average time per query and the average fraction of the
+  * vertices settled by the bidirectional search
+  */
+void benchmark_point_to_point(const std::size_t n, const std::size_t queries) {
+    const std::size_t m{AVERAGE_DEGREE * n};
+    Edge* edges = new Edge[m];
+    generate_edges(edges, m, n);
+    CSRGraph graph{edges, m, n};
+    delete[] edges;
+    CSRGraph* reverse{graph.reverse()};
+    Vertex* V = new Vertex[n];
+    DijkstraWorkspace forward{n};
+    DijkstraWorkspace backward{n};
+    ShortestPath path;
+    long long full{0};
+    long long bidirectional{0};
+    std::size_t settled{0};
+    bool correct{true};
+    for (std::size_t q=0; q < queries; ++q) {
+        const int s{static_cast<int>(rand() % n)};
+        const int t{static_cast<int>(rand() % n)};
+        for (std::size_t i=0; i < n; ++i) {
+            V[i] = Vertex{static_cast<int>(i)};
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        dijkstra<BinaryHeap<Vertex, CompareVertex, VertexHandle>>(graph, V, V[s]);
+        auto end = std::chrono::high_resolution_clock::now();
+        full += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        start = std::chrono::high_resolution_clock::now();
+        bidirectional_dijkstra(graph, *reverse, s, t, forward, backward, path);
+        end = std::chrono::high_resolution_clock::now();
+        bidirectional += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        settled += path.settled;
+        correct = correct && path.distance == V[t].d && check_path(graph, path, s, t);
+    }
+    std::cout << "Vertices: " << n << " Edges: " << m << " Queries: " << queries << std::endl;
+    std::cout << "Dijkstra: " << full / static_cast<long long>(queries) << std::endl;
+    std::cout << "Bidirectional Dijkstra: " << bidirectional / static_cast<long long>(queries) << std::endl;
+    std::cout << "Settled: " << 100.0 * settled / (static_cast<double>(queries) * n) << "%" << std::endl;
+    std::cout << (correct ? "distances match" : "DISTANCES DIFFER") << std::endl;
+    delete[] V;
+    delete reverse;
+}
+
+/**
+  * Run 'queries' A* searches between the given pairs of vertices of 'graph' with 'heuristic', checking the distances
+  * against 'reference'. Prints the average time per query and the average fraction of the vertices settled
+  */
+template<class Heuristic>
+void time_astar(const char* name, const CSRGraph& graph, const Heuristic& heuristic, const int* pairs, const int* reference, const std::size_t queries) {
+    DijkstraWorkspace workspace{graph.n};
+    ShortestPath path;
+    long long time{0};
+    std::size_t settled{0};
+    bool correct{true};
+    for (std::size_t q=0; q < queries; ++q) {
+        auto start = std::chrono::high_resolution_clock::now();
+        astar(graph, pairs[2 * q], pairs[2 * q + 1], heuristic, workspace, path);
+        auto end = std::chrono::high_resolution_clock::now();
+        time += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        settled += path.settled;
+        correct = correct && path.distance == reference[q] && check_path(graph, path, pairs[2 * q], pairs[2 * q + 1]);
+    }
+    std::cout << name << ": " << time / static_cast<long long>(queries) << " Settled: "
+              << 100.0 * settled / (static_cast<double>(queries) * graph.n) << "%"
+              << (correct ? "" : " DISTANCES DIFFER") << std::endl;
+}
+
+/**
+  * Fill 'edges' with the edges of a 'side' x 'side' grid, where each vertex is joined to its four neighbors in both
+  * directions by edges of weight 10 to 19, that is the straight-line distance times a random detour factor, and
+  * 'x' and 'y' with the coordinates of the vertices. With 'highways', like a road network, every tenth row and
+  * column is a faster road with weights 3 to 5, and every hundredth a highway with weights 1 and 2.
+  * 'edges' must have room for 4 * side * side edges; returns their number
+  */
+std::size_t generate_grid(Edge* edges, double* x, double* y, const std::size_t side, const bool highways=false) {
+    // weight of an edge along the given row or column
+    const auto weight = [highways](const std::size_t line) {
+        if (highways && line % 100 == 0) {
+            return rand() % 2 + 1;
+        }
+        if (highways && line % 10 == 0) {
+            return rand() % 3 + 3;
+        }
+        return rand() % 10 + 10;
+    };
+    std::size_t m{0};
+    for (std::size_t r=0; r < side; ++r) {
+        for (std::size_t c=0; c < side; ++c) {
+            const int v{static_cast<int>(r * side + c)};
+            x[v] = c;
+            y[v] = r;
+            if (c + 1 < side) {
+                edges[m++] = Edge{v, v + 1, weight(r)};
+                edges[m++] = Edge{v + 1, v, weight(r)};
+            }
+            if (r + 1 < side) {
+                edges[m++] = Edge{v, static_cast<int>(v + side), weight(c)};
+                edges[m++] = Edge{static_cast<int>(v + side), v, weight(c)};
+            }
+        }
+    }
+    return m;
+}
+
+/**
+  * Draw 'queries' random pairs of vertices of 'graph' into 'pairs', and store their distances in 'reference'
+  */
+void generate_queries(const CSRGraph& graph, int* pairs, int* reference, const std::size_t queries) {
+    Vertex* V = new Vertex[graph.n];
+    for (std::size_t q=0; q < queries; ++q) {
+        pairs[2 * q] = rand() % graph.n;
+        pairs[2 * q + 1] = rand() % graph.n;
+        for (std::size_t i=0; i < graph.n; ++i) {
+            V[i] = Vertex{static_cast<int>(i)};
+        }
+        dijkstra<RadixHeap>(graph, V, V[pairs[2 * q]]);
+        reference[q] = V[pairs[2 * q + 1]].d;
+    }
+    delete[] V;
+}
+
+/**
+  * Compare the heuristics of A* on a 'side' x 'side' grid (see generate_grid). The landmarks are computed once and
+  * cached in 'cache', then loaded back from it
+  */
+void benchmark_astar(const std::size_t side, const std::size_t queries, const char* cache) {
+    const std::size_t n{side * side};
+    Edge* edges = new Edge[4 * n];
+    double* x = new double[n];
+    double* y = new double[n];
+    const std::size_t m{generate_grid(edges, x, y, side)};
+    CSRGraph graph{edges, m, n};
+    delete[] edges;
+    CSRGraph* reverse{graph.reverse()};
+    int* pairs = new int[2 * queries];
+    int* reference = new int[queries];
+    generate_queries(graph, pairs, reference, queries);
+    std::cout << "Grid: " << side << " x " << side << " Queries: " << queries << std::endl;
+    time_astar("Dijkstra stopped at t", graph, ZeroHeuristic{}, pairs, reference, queries);
+    time_astar("Euclidean", graph, GeometricHeuristic<EuclideanMetric>{graph, x, y}, pairs, reference, queries);
+    std::remove(cache);
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        Landmarks landmarks{graph, *reverse, 16, cache};
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "Landmarks computed: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << std::endl;
+    }
+    start = std::chrono::high_resolution_clock::now();
+    Landmarks landmarks{graph, *reverse, 16, cache};
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Landmarks loaded: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << std::endl;
+    time_astar("16 landmarks", graph, landmarks, pairs, reference, queries);
+    std::remove(cache);
+    delete[] reference;
+    delete[] pairs;
+    delete[] x;
+    delete[] y;
+    delete reverse;
+}
+
+/**
+  * Preprocess a 'side' x 'side' grid with highways (see generate_grid) into a contraction hierarchy, save it to 'file' and load it
+  * back, then compare its queries with the bidirectional Dijkstra's algorithm
+  */
+void benchmark_hierarchy(const std::size_t side, const std::size_t queries, const char* file) {
+    const std::size_t n{side * side};
+    Edge* edges = new Edge[4 * n];
+    double* x = new double[n];
+    double* y = new double[n];
+    const std::size_t m{generate_grid(edges, x, y, side, true)};
+    CSRGraph graph{edges, m, n};
+    delete[] edges;
+    delete[] x;
+    delete[] y;
+    CSRGraph* reverse{graph.reverse()};
+    int* pairs = new int[2 * queries];
+    int* reference = new int[queries];
+    generate_queries(graph, pairs, reference, queries);
+    std::cout << "Grid: " << side << " x " << side << " Queries: " << queries << std::endl;
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        ContractionHierarchy built{graph};
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "Preprocessing: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+                  << " Edges: " << m << " Hierarchy edges: " << built.edges() << std::endl;
+        built.save(file);
+    }
+    start = std::chrono::high_resolution_clock::now();
+    ContractionHierarchy ch{file};
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Loading: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << std::endl;
+    std::remove(file);
+    HierarchyQuery query{ch};
+    DijkstraWorkspace forward{n};
+    DijkstraWorkspace backward{n};
+    ShortestPath path;
+    long long bidirectional{0};
+    long long hierarchy{0};
+    std::size_t settled{0};
+    bool correct{true};
+    for (std::size_t q=0; q < queries; ++q) {
+        start = std::chrono::high_resolution_clock::now();
+        bidirectional_dijkstra(graph, *reverse, pairs[2 * q], pairs[2 * q + 1], forward, backward, path);
+        end = std::chrono::high_resolution_clock::now();
+        bidirectional += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        start = std::chrono::high_resolution_clock::now();
+        query.query(pairs[2 * q], pairs[2 * q + 1], path);
+        end = std::chrono::high_resolution_clock::now();
+        hierarchy += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        settled += path.settled;
+        correct = correct && path.distance == reference[q] && check_path(graph, path, pairs[2 * q], pairs[2 * q + 1]);
+    }
+    std::cout << "Bidirectional Dijkstra: " << bidirectional / static_cast<long long>(queries) << std::endl;
+    std::cout << "Contraction hierarchy: " << hierarchy / static_cast<long long>(queries) << " Settled: "
+              << settled / queries << std::endl;
+    std::cout << (correct ? "distances match" : "DISTANCES DIFFER") << std::endl;
+    delete[] reference;
+    delete[] pairs;
+    delete reverse;
+}
+
+/**
+  * Compare back-to-back local queries with and without a DijkstraWorkspace, on a generated sparse graph with 'n'
+  * vertices. Each query goes from a random vertex to the 'reach'-th vertex settled from it, so it settles 'reach'
+  * vertices: a new workspace for each query allocates and initializes Θ(n) memory each time, while a reused one
+  * only bumps its epoch. The first full run in the workspace is checked against Dijkstra's algorithm with a BinaryHeap
+  */
+void benchmark_workspace(const std::size_t n, const std::size_t queries, const std::size_t reach) {
+    const std::size_t m{AVERAGE_DEGREE * n};
+    Edge* edges = new Edge[m];
+    generate_edges(edges, m, n);
+    CSRGraph graph{edges, m, n};
+    delete[] edges;
+    DijkstraWorkspace workspace{n};
+    // before its first run, the workspace has reached no vertex
+    bool correct{workspace.distance(0) == INT_MAX && workspace.predecessor(0) == -1 && !workspace.is_settled(0)};
+    {
+        Vertex* V = new Vertex[n];
+        time_dijkstra<BinaryHeap<Vertex, CompareVertex, VertexHandle>>(graph, V);
+        dijkstra(graph, 0, workspace);
+        for (std::size_t v=0; v < n; ++v) {
+            correct = correct && workspace.distance(v) == V[v].d;
+        }
+        delete[] V;
+    }
+    int* pairs = new int[2 * queries];
+    for (std::size_t q=0; q < queries; ++q) {
+        pairs[2 * q] = rand() % n;
+        pairs[2 * q + 1] = pairs[2 * q];
+        workspace.search(graph, pairs[2 * q], [&](const int v) {
+            pairs[2 * q + 1] = v;
+            return workspace.size() < reach;
+        });
+    }
+    ShortestPath path;
+    int* reference = new int[queries];
+    auto start = std::chrono::high_resolution_clock::now();
+    for (std::size_t q=0; q < queries; ++q) {
+        DijkstraWorkspace fresh{n};
+        reference[q] = dijkstra(graph, pairs[2 * q], pairs[2 * q + 1], fresh, path);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Vertices: " << n << " Edges: " << m << " Queries: " << queries << " Settled: " << reach << std::endl;
+    std::cout << "Without workspace: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / static_cast<long long>(queries) << std::endl;
+    start = std::chrono::high_resolution_clock::now();
+    for (std::size_t q=0; q < queries; ++q) {
+        correct = correct && dijkstra(graph, pairs[2 * q], pairs[2 * q + 1], workspace, path) == reference[q];
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "With workspace: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / static_cast<long long>(queries) << std::endl;
+    std::cout << (correct ? "distances match" : "DISTANCES DIFFER") << std::endl;
+    delete[] reference;
+    delete[] pairs;
+}
 
-int main() {
+/**
+  * Compute the 'count' x 'count' distance table between random vertices of a 'side' x 'side' grid with highways (see
+  * generate_grid), with one Dijkstra's search per source and with the buckets of a contraction hierarchy, then a
+  * 'large' x 'large' table with the hierarchy only. The two small tables are compared, and a few rows of the large
+  * one are checked against a whole Dijkstra's search
+  */
+void benchmark_distance_table(const std::size_t side, const std::size_t count, const std::size_t large) {
+    const std::size_t n{side * side};
+    Edge* edges = new Edge[4 * n];
+    double* x = new double[n];
+    double* y = new double[n];
+    const std::size_t m{generate_grid(edges, x, y, side, true)};
+    CSRGraph graph{edges, m, n};
+    delete[] edges;
+    delete[] x;
+    delete[] y;
+    int* sources = new int[large];
+    int* targets = new int[large];
+    for (std::size_t i=0; i < large; ++i) {
+        sources[i] = rand() % n;
+        targets[i] = rand() % n;
+    }
+    int* table = new int[large * large];
+    int* reference = new int[count * count];
+    std::cout << "Grid: " << side << " x " << side << " Table: " << count << " x " << count << std::endl;
+    auto start = std::chrono::high_resolution_clock::now();
+    distance_table(graph, sources, count, targets, count, reference);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Dijkstra's searches: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << std::endl;
+    start = std::chrono::high_resolution_clock::now();
+    ContractionHierarchy ch{graph};
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "Preprocessing: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << std::endl;
+    start = std::chrono::high_resolution_clock::now();
+    distance_table(ch, sources, count, targets, count, table);
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "Contraction hierarchy: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << std::endl;
+    bool correct{true};
+    for (std::size_t i=0; i < count * count; ++i) {
+        correct = correct && table[i] == reference[i];
+    }
+    start = std::chrono::high_resolution_clock::now();
+    distance_table(ch, sources, large, targets, large, table);
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "Contraction hierarchy, " << large << " x " << large << ": "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << std::endl;
+    DijkstraWorkspace workspace{n};
+    for (std::size_t i=0; i < large; i += large / 10) {
+        dijkstra(graph, sources[i], workspace);
+        for (std::size_t j=0; j < large; ++j) {
+            correct = correct && table[i * large + j] == workspace.distance(targets[j]);
+        }
+    }
+    std::cout << (correct ? "distances match" : "DISTANCES DIFFER") << std::endl;
+    delete[] reference;
+    delete[] table;
+    delete[] targets;
+    delete[] sources;
+}
+
+/**
+  * Whether the graphs 'a' and 'b' have the same edges, in the same order
+  */
+bool same_graph(const CSRGraph& a, const CSRGraph& b) {
+    if (a.n != b.n || a.m != b.m) {
+        return false;
+    }
+    for (std::size_t u=0; u <= a.n; ++u) {
+        if (a.offsets[u] != b.offsets[u]) return false;
+    }
+    for (std::size_t e=0; e < a.m; ++e) {
+        if (a.targets[e] != b.targets[e] || a.weights[e] != b.weights[e]) return false;
+    }
+    return true;
+}
+
+/**
+  * Write a generated graph with 'n' vertices as a DIMACS file, an edge list and a Matrix Market file in /tmp, load
+  * each of them back with one and with four threads, and check the result against the original graph. Then save a
+  * snapshot and map it back. Prints the time taken by each loader in milliseconds
+  */
+void test_loaders(const std::size_t n) {
+    const std::size_t m{AVERAGE_DEGREE * n};
+    Edge* edges = new Edge[m];
+    generate_edges(edges, m, n);
+    CSRGraph graph{edges, m, n};
+    const char* paths[3] = {"/tmp/dijkstra_test.gr", "/tmp/dijkstra_test.txt", "/tmp/dijkstra_test.mtx"};
+    FILE* files[3] = {std::fopen(paths[0], "w"), std::fopen(paths[1], "w"), std::fopen(paths[2], "w")};
+    std::fprintf(files[0], "c generated graph\np sp %zu %zu\n", n, m);
+    std::fprintf(files[1], "# generated graph\n");
+    std::fprintf(files[2], "%%%%MatrixMarket matrix coordinate integer general\n%% generated graph\n%zu %zu %zu\n", n, n, m);
+    for (std::size_t e=0; e < m; ++e) {
+        std::fprintf(files[0], "a %d %d %d\n", edges[e].source + 1, edges[e].target + 1, edges[e].weight);
+        std::fprintf(files[1], "%d %d %d\n", edges[e].source, edges[e].target, edges[e].weight);
+        std::fprintf(files[2], "%d %d %d\n", edges[e].source + 1, edges[e].target + 1, edges[e].weight);
+    }
+    for (FILE* f : files) {
+        std::fclose(f);
+    }
+    delete[] edges;
+    CSRGraph* (*loaders[3])(const char*, const std::size_t) = {load_dimacs, load_edge_list, load_matrix_market};
+    const char* names[3] = {"DIMACS", "Edge list", "Matrix Market"};
+    std::cout << "Vertices: " << n << " Edges: " << m << std::endl;
+    for (std::size_t f=0; f < 3; ++f) {
+        for (std::size_t threads : {1, 4}) {
+            auto start = std::chrono::high_resolution_clock::now();
+            CSRGraph* loaded{loaders[f](paths[f], threads)};
+            auto end = std::chrono::high_resolution_clock::now();
+            std::cout << names[f] << " Threads: " << threads << " Load: "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()
+                      << (same_graph(graph, *loaded) ? " correct" : " WRONG") << std::endl;
+            delete loaded;
+        }
+        std::remove(paths[f]);
+    }
+    const char* snapshot_path{"/tmp/dijkstra_test.csr"};
+    auto start = std::chrono::high_resolution_clock::now();
+    save_snapshot(graph, snapshot_path);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Snapshot save: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    for (bool validate : {true, false}) {
+        start = std::chrono::high_resolution_clock::now();
+        GraphSnapshot snapshot{snapshot_path, validate};
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << (validate ? " Map and validate: " : " Map trusted: ")
+                  << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << "us"
+                  << (same_graph(graph, snapshot.graph()) ? " correct" : " WRONG");
+    }
+    std::cout << std::endl;
+    std::remove(snapshot_path);
+}
+
+/**
+  * Load the graph in the file 'path', according to its extension: .gr for DIMACS, .mtx for Matrix Market,
+  * .csr for a snapshot and anything else for an edge list. Runs Dijkstra's algorithm from vertex 0 with the
+  * BinaryHeap and, if 'snapshot_path' is not null, saves the graph as a snapshot there
+  */
+void run_on_file(const char* path, const char* snapshot_path) {
+    const char* extension{std::strrchr(path, '.')};
+    extension = (extension == nullptr) ? "" : extension;
+    GraphSnapshot* snapshot{nullptr};
+    CSRGraph* loaded{nullptr};
+    auto start = std::chrono::high_resolution_clock::now();
+    if (std::strcmp(extension, ".csr") == 0) {
+        snapshot = new GraphSnapshot{path};
+    }
+    else if (std::strcmp(extension, ".gr") == 0) {
+        loaded = load_dimacs(path);
+    }
+    else if (std::strcmp(extension, ".mtx") == 0) {
+        loaded = load_matrix_market(path);
+    }
+    else {
+        loaded = load_edge_list(path);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    const CSRGraph& graph = (snapshot != nullptr) ? snapshot->graph() : *loaded;
+    std::cout << "Vertices: " << graph.n << " Edges: " << graph.m << " Load (ms): "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << std::endl;
+    if (snapshot_path != nullptr) {
+        save_snapshot(graph, snapshot_path);
+    }
+    if (graph.n > 0) {
+        Vertex* V = new Vertex[graph.n];
+        std::cout << "BinaryHeap (ns): " << time_dijkstra<BinaryHeap<Vertex, CompareVertex, VertexHandle>>(graph, V) << std::endl;
+        std::size_t reached{0};
+        for (std::size_t i=0; i < graph.n; ++i) {
+            reached += (V[i].d != INT_MAX);
+        }
+        std::cout << "Vertices reached from 0: " << reached << std::endl;
+        delete[] V;
+    }
+    delete loaded;
+    delete snapshot;
+}
+
+
+/**
+  * Without arguments, runs the tests below. Otherwise, usage:
+  *     ./dijkstra.x graph_file [snapshot_file]
+  * loads the graph in 'graph_file' (see run_on_file), runs Dijkstra's algorithm on it, and saves a snapshot if asked
+  */
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        run_on_file(argv[1], argc > 2 ? argv[2] : nullptr);
+        return 0;
+    }
     // initialize list of vertices and adjacency matrix, which will be a pointer to pointer
     Vertex* vertices = new Vertex[N];
     for (int i = 0; i < N; ++i) {
@@ -57,7 +874,7 @@ int main() {
     // test first with BinaryHeap
     std::cout << "Tests with lecture graph" << std::endl;
     auto start = std::chrono::high_resolution_clock::now();
-    dijkstra<BinaryHeap<Vertex, CompareVertex>>(graph, vertices, N, vertices[0]);
+    dijkstra<BinaryHeap<Vertex, CompareVertex, VertexHandle>>(graph, vertices, N, vertices[0]);
     auto end = std::chrono::high_resolution_clock::now();
     std::cout << "BinaryHeap implementation: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << std::endl;
     // check result
@@ -70,6 +887,21 @@ int main() {
         vertices[i].pred = -1;
         vertices[i].d = INT_MAX;
     }
+    // test with RadixHeap
+    start = std::chrono::high_resolution_clock::now();
+    dijkstra<RadixHeap>(graph, vertices, N, vertices[0]);
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "RadixHeap implementation: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << std::endl;
+    // check result
+    for (int i=0; i < 6; ++i) {
+        std::cout << "node number: " << vertices[i].index << " has distance: " << vertices[i].d << std::endl;
+    }
+    // reset vertices' members
+    for (int i=0; i < 6; ++i) {
+        vertices[i].on_queue = true;
+        vertices[i].pred = -1;
+        vertices[i].d = INT_MAX;
+    }
     // test with Queue
     start = std::chrono::high_resolution_clock::now();
     dijkstra<Queue>(graph, vertices, N, vertices[0]);
@@ -79,7 +911,68 @@ int main() {
     for (int i=0; i < 6; ++i) {
         std::cout << "node number: " << vertices[i].index << " has distance: " << vertices[i].d << std::endl;
     }
+    // test with the CSR form of the same graph
+    {
+        CSRGraph csr{graph, N};
+        for (int i=0; i < N; ++i) {
+            vertices[i] = Vertex{i};
+        }
+        start = std::chrono::high_resolution_clock::now();
+        dijkstra<BinaryHeap<Vertex, CompareVertex, VertexHandle>>(csr, vertices, vertices[0]);
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "BinaryHeap on CSR implementation: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << std::endl;
+        for (int i=0; i < 6; ++i) {
+            std::cout << "node number: " << vertices[i].index << " has distance: " << vertices[i].d << std::endl;
+        }
+    }
     // deallocate
     delete[] vertices;
+    // compare the queue engines on generated graphs: sparse ones, where the heaps beat the linear scan of
+    // the array, and dense ones, where decrease-key operations vastly outnumber the extractions
+    std::cout << "Tests with generated graphs" << std::endl;
+    srand(0);
+    for (int density : {1, 10, 50}) {
+        benchmark_queues<500>(density);
+        benchmark_queues<2000>(density);
+        benchmark_queues<5000>(density);
+    }
+    // compare the heap-based engines on sparse graphs in CSR form, with an average degree of 4
+    std::cout << "Tests with generated sparse graphs" << std::endl;
+    for (std::size_t n : {100000, 1000000, 10000000}) {
+        benchmark_sparse(n);
+    }
+    // compare delta-stepping, which relaxes whole buckets of vertices in parallel, with Dijkstra's algorithm
+    std::cout << "Tests with delta-stepping" << std::endl;
+    for (std::size_t n : {100000, 1000000, 10000000}) {
+        benchmark_delta_stepping(n);
+    }
+    // point-to-point queries, where the bidirectional search stops long before settling every vertex
+    std::cout << "Tests with point-to-point queries" << std::endl;
+    for (std::size_t n : {100000, 1000000}) {
+        benchmark_point_to_point(n, 20);
+    }
+    // A* searches, guided towards the target by the coordinates of the vertices or by landmarks
+    std::cout << "Tests with A* search" << std::endl;
+    for (std::size_t side : {300, 1000}) {
+        benchmark_astar(side, 20, "/tmp/dijkstra_landmarks.alt");
+    }
+    // contraction hierarchies, preprocessed once for many point-to-point queries
+    std::cout << "Tests with contraction hierarchies" << std::endl;
+    for (std::size_t side : {100, 300}) {
+        benchmark_hierarchy(side, 100, "/tmp/dijkstra_hierarchy.ch");
+    }
+    // local queries in a large graph, where resetting the vertices and building the queue would dominate
+    std::cout << "Tests with a reusable workspace" << std::endl;
+    for (std::size_t n : {1000000, 10000000}) {
+        benchmark_workspace(n, 100, 2000);
+    }
+    // many-to-many distance tables, from one search per source or from the buckets of a contraction hierarchy
+    std::cout << "Tests with distance tables" << std::endl;
+    benchmark_distance_table(200, 100, 2000);
+    // load the same graph from the text formats and from a snapshot
+    std::cout << "Tests with graph files" << std::endl;
+    for (std::size_t n : {1000, 1000000}) {
+        test_loaders(n);
+    }
     return 0;
 }
@@ -0,0 +1,217 @@
+#ifndef __DIJKSTRA_WORKSPACE__
+#define __DIJKSTRA_WORKSPACE__
+
+/**
+  * This header file contains a workspace for back-to-back runs of Dijkstra's algorithm on the same graph in CSR form.
+  * dijkstra<Q> needs an array of graph.n Vertex instances reset before each run, and builds a queue over all of them,
+  * so even a query that settles a handful of vertices costs Θ(n). The workspace allocates its arrays once, and an
+  * epoch stamp tells which of their entries have been written by the current run: starting a new run only increments
+  * the epoch, and a run costs time in the number of vertices it reaches, whatever the size of the graph.
+  */
+
+#include <cstdint>
+#include <climits>
+
+#include "graph_utilities.h"
+#include "csr_graph.h"
+#include "heap.h"
+
+/**
+  * Result of a point-to-point query: the distance from the source to the target and the vertices of a shortest path
+  * between them, from the source to the target. If the target cannot be reached, the distance is INT_MAX and the
+  * path is empty
+  */
+struct ShortestPath {
+    int distance;  // length of the path, INT_MAX if there is none
+    int* vertices;  // the vertices of the path
+    std::size_t length;  // number of vertices of the path
+    std::size_t capacity;  // length of 'vertices'
+    std::size_t settled;  // number of vertices settled by the query, to measure the size of the search
+
+    ShortestPath() : distance{INT_MAX}, vertices{nullptr}, length{0}, capacity{0}, settled{0} {}
+    ShortestPath(const ShortestPath&) = delete;
+    ShortestPath& operator=(const ShortestPath&) = delete;
+    // forget the previous path, making room for 'n' vertices
+    void reset(const std::size_t n) {
+        if (n > capacity) {
+            delete[] vertices;
+            vertices = new int[n];
+            capacity = n;
+        }
+        distance = INT_MAX;
+        length = 0;
+        settled = 0;
+    }
+    // append 'v' to the path, making room for it if needed
+    void push(const int v) {
+        if (length == capacity) {
+            capacity = (capacity == 0) ? 64 : 2 * capacity;
+            int* new_vertices{new int[capacity]};
+            for (std::size_t i=0; i < length; ++i) {
+                new_vertices[i] = vertices[i];
+            }
+            delete[] vertices;
+            vertices = new_vertices;
+        }
+        vertices[length++] = v;
+    }
+    // Destructor
+    ~ShortestPath() {
+        delete[] vertices;
+    }
+};
+
+/**
+  * Distances, predecessors and queue of Dijkstra's algorithm, for graphs with up to 'n' vertices. The distance and
+  * the predecessor of a vertex are valid only if its stamp 'reached' equals the current epoch, and it is settled
+  * only if its stamp 'settled' does; every other vertex is at distance INT_MAX, with no predecessor. The queue is a
+  * 4-ary heap with lazy deletion, whose array keeps its capacity from one run to the next. Epoch 0 is reserved for
+  * "never", so the stamps start at 0 and the epochs at 1; when the 32-bit epoch wraps around, after about 4 billion
+  * runs, the stamps are cleared once. Besides 'search', the members 'start', 'lower', 'is_done', 'next_key' and
+  * 'settle' let the point-to-point searches of point_to_point.h drive a run one vertex at a time, with their own keys
+  */
+class DijkstraWorkspace {
+    std::size_t n;  // number of vertices
+    int* dist;  // distance of each vertex reached by the current run
+    int* pred;  // predecessor of each vertex reached by the current run
+    std::uint32_t* reached;  // epoch in which 'dist' and 'pred' of each vertex have last been set
+    std::uint32_t* settled;  // epoch in which each vertex has last been settled
+    std::uint32_t epoch;  // the current run
+    std::size_t num_settled;  // number of vertices settled by the current run
+    DaryHeap<SearchEntry, CompareEntries, 4> heap;  // the queue
+
+  public:
+    // Constructor, builds a workspace for graphs with 'num_vertices' vertices
+    explicit DijkstraWorkspace(const std::size_t num_vertices) :
+        n{num_vertices}, dist{new int[num_vertices]}, pred{new int[num_vertices]}, reached{new std::uint32_t[num_vertices]},
+        settled{new std::uint32_t[num_vertices]}, epoch{1}, num_settled{0}, heap{} {
+        for (std::size_t v=0; v < n; ++v) {
+            reached[v] = 0;
+            settled[v] = 0;
+        }
+    }
+    DijkstraWorkspace(const DijkstraWorkspace&) = delete;
+    DijkstraWorkspace& operator=(const DijkstraWorkspace&) = delete;
+    // forget the previous run in O(1), or in O(n) once every 2^32 runs
+    void reset() noexcept {
+        heap.size = 0;
+        num_settled = 0;
+        if (++epoch == 0) {
+            for (std::size_t v=0; v < n; ++v) {
+                reached[v] = 0;
+                settled[v] = 0;
+            }
+            epoch = 1;
+        }
+    }
+    // distance of 'v' found by the last run, INT_MAX if it has not been reached; it is final if 'v' is settled
+    int distance(const int v) const noexcept {
+        return (reached[v] == epoch) ? dist[v] : INT_MAX;
+    }
+    // predecessor of 'v' on the path found by the last run, -1 if none
+    int predecessor(const int v) const noexcept {
+        return (reached[v] == epoch) ? pred[v] : -1;
+    }
+    bool is_settled(const int v) const noexcept {
+        return settled[v] == epoch;
+    }
+    // number of vertices settled by the last run
+    std::size_t size() const noexcept {
+        return num_settled;
+    }
+    // start a new run from 's', forgetting the previous one; 's' is queued with key 'key'
+    void start(const int s, const int key=0) {
+        reset();
+        lower(s, 0, -1, key);
+    }
+    // set the distance of 'v' to 'd' through 'p', and queue it with key 'key', which is 'd' for Dijkstra's algorithm;
+    // 'v' must not be settled, and 'd' must be smaller than its distance
+    void lower(const int v, const int d, const int p, const int key) {
+        dist[v] = d;
+        pred[v] = p;
+        reached[v] = epoch;
+        heap.push(SearchEntry{key, v});
+    }
+    // true if no vertex is left to settle; the outdated entries, pushed before the distance of their vertex
+    // decreased, are dropped from the top of the queue on the way
+    bool is_done() {
+        while (!heap.is_empty() && settled[heap.top().v] == epoch) {
+            heap.pop();
+        }
+        return heap.is_empty();
+    }
+    // key of the next vertex to settle; the run must not be done
+    int next_key() const noexcept {
+        return heap.top().d;
+    }
+    // settle the vertex with the smallest key and return it; the run must not be done
+    int settle() {
+        const int v{heap.pop().v};
+        settled[v] = epoch;
+        ++num_settled;
+        return v;
+    }
+    // Run Dijkstra's algorithm from 's' on 'graph', calling 'visit(v)' as each vertex v is settled; the run stops
+    // early as soon as 'visit' returns false. The previous run is forgotten first
+    template<class Visit>
+    void search(const CSRGraph& graph, const int s, Visit visit) {
+        start(s);
+        while (!is_done()) {
+            const int u{settle()};
+            if (!visit(u)) {
+                return;
+            }
+            for (std::size_t i=graph.offsets[u]; i < graph.offsets[u + 1]; ++i) {
+                const int x{graph.targets[i]};
+                const long long d{static_cast<long long>(dist[u]) + graph.weights[i]};
+                if (settled[x] != epoch && d < distance(x)) {
+                    lower(x, static_cast<int>(d), u, static_cast<int>(d));
+                }
+            }
+        }
+    }
+    // store in 'path' the path to 't' found by the last run, which must have settled 't' to be a shortest one
+    void path_to(const int t, ShortestPath& path) const {
+        path.reset(0);
+        path.settled = num_settled;
+        if (reached[t] != epoch) {
+            return;
+        }
+        path.distance = dist[t];
+        for (int v=t; v != -1; v = pred[v]) {
+            path.push(v);
+        }
+        for (std::size_t i=0, j=path.length - 1; i < j; ++i, --j) {
+            const int tmp{path.vertices[i]};
+            path.vertices[i] = path.vertices[j];
+            path.vertices[j] = tmp;
+        }
+    }
+    // Destructor
+    ~DijkstraWorkspace() {
+        delete[] dist;
+        delete[] pred;
+        delete[] reached;
+        delete[] settled;
+    }
+};
+
+/**
+  * Run Dijkstra's algorithm from 's' on the CSR 'graph' in 'workspace', which then holds the distances and the
+  * predecessors of all the vertices
+  */
+inline void dijkstra(const CSRGraph& graph, const int s, DijkstraWorkspace& workspace) {
+    workspace.search(graph, s, [](int) {return true;});
+}
+
+/**
+  * Find a shortest path from 's' to 't' in the CSR 'graph' with Dijkstra's algorithm in 'workspace', stopping as soon
+  * as 't' is settled, and store it in 'path'; returns its length, INT_MAX if 't' cannot be reached
+  */
+inline int dijkstra(const CSRGraph& graph, const int s, const int t, DijkstraWorkspace& workspace, ShortestPath& path) {
+    workspace.search(graph, s, [t](const int v) {return v != t;});
+    workspace.path_to(t, path);
+    return path.distance;
+}
+
+#endif  // __DIJKSTRA_WORKSPACE__
@@ -0,0 +1,136 @@
+#ifndef __DISTANCE_TABLE__
+#define __DISTANCE_TABLE__
+
+/**
+  * This header file contains the many-to-many shortest path computations: given a set S of sources and a set T of
+  * targets, they fill the |S| x |T| table of the distances from each source to each target, on several threads
+  */
+
+#include <climits>
+
+#include "graph_utilities.h"
+#include "csr_graph.h"
+#include "graph_io.h"
+#include "dijkstra_workspace.h"
+#include "contraction_hierarchy.h"
+
+/**
+  * Fill 'table' with the distances from the 'num_sources' vertices of 'sources' to the 'num_targets' vertices of
+  * 'targets' in the CSR 'graph': table[i * num_targets + j] is the distance from sources[i] to targets[j], INT_MAX if
+  * there is no path. One Dijkstra's search runs per source, spread over 'threads' threads, each reusing its own
+  * DijkstraWorkspace; a search stops as soon as all the targets are settled, so close targets make for short searches
+  */
+inline void distance_table(const CSRGraph& graph, const int* sources, const std::size_t num_sources, const int* targets,
+                           const std::size_t num_targets, int* table, std::size_t threads=default_threads()) {
+    threads = (threads > 0) ? threads : 1;
+    // flag the targets, counting each vertex once even if it is given more than once
+    char* is_target = new char[graph.n];
+    for (std::size_t v=0; v < graph.n; ++v) {
+        is_target[v] = 0;
+    }
+    std::size_t distinct{0};
+    for (std::size_t j=0; j < num_targets; ++j) {
+        distinct += !is_target[targets[j]];
+        is_target[targets[j]] = 1;
+    }
+    DijkstraWorkspace** workspaces{new DijkstraWorkspace*[threads]};
+    for (std::size_t t=0; t < threads; ++t) {
+        workspaces[t] = new DijkstraWorkspace{graph.n};
+    }
+    parallel_for(num_sources, threads, [&](const std::size_t i, const std::size_t t) {
+        DijkstraWorkspace& workspace = *workspaces[t];
+        std::size_t found{0};
+        workspace.search(graph, sources[i], [&](const int v) {
+            found += is_target[v];
+            return found < distinct;
+        });
+        for (std::size_t j=0; j < num_targets; ++j) {
+            table[i * num_targets + j] = workspace.is_settled(targets[j]) ? workspace.distance(targets[j]) : INT_MAX;
+        }
+    });
+    for (std::size_t t=0; t < threads; ++t) {
+        delete workspaces[t];
+    }
+    delete[] workspaces;
+    delete[] is_target;
+}
+
+/**
+  * Same as above on a ContractionHierarchy, with the bucket algorithm of Knopp, Sanders, Schultes, Schulz and Wagner.
+  * First, an upward search runs backwards from each target t, and each vertex v it settles gets an entry (t, d(v, t))
+  * in its bucket. Then an upward search runs forwards from each source s, and each vertex v it settles combines
+  * d(s, v) with the entries of its bucket: since a shortest path from s to t goes up to its highest vertex and then
+  * down, the smallest sum over the vertices settled by both searches is d(s, t). The searches of each phase run in
+  * parallel in per-thread workspaces, and the buckets are gathered in between with a counting sort by vertex. Each
+  * search only covers the few hundred vertices above its start, so the whole table costs about |S| + |T| searches
+  * plus one addition per pair of entries that meet, rather than |S| searches on the whole graph
+  */
+inline void distance_table(const ContractionHierarchy& ch, const int* sources, const std::size_t num_sources, const int* targets,
+                           const std::size_t num_targets, int* table, std::size_t threads=default_threads()) {
+    threads = (threads > 0) ? threads : 1;
+    const std::size_t n{ch.size()};
+    // the entries found by each thread, as triples (vertex, target index, distance)
+    VertexList* found{new VertexList[threads]};
+    DijkstraWorkspace** workspaces{new DijkstraWorkspace*[threads]};
+    for (std::size_t t=0; t < threads; ++t) {
+        workspaces[t] = new DijkstraWorkspace{n};
+    }
+    parallel_for(num_targets, threads, [&](const std::size_t j, const std::size_t t) {
+        DijkstraWorkspace& workspace = *workspaces[t];
+        workspace.search(ch.graph(true), targets[j], [&](const int v) {
+            found[t].push(v);
+            found[t].push(static_cast<int>(j));
+            found[t].push(workspace.distance(v));
+            return true;
+        });
+    });
+    // gather the entries in buckets by vertex: bucket v is entries [offsets[v], offsets[v + 1])
+    std::size_t* offsets{new std::size_t[n + 1]};
+    for (std::size_t v=0; v <= n; ++v) {
+        offsets[v] = 0;
+    }
+    for (std::size_t t=0; t < threads; ++t) {
+        for (std::size_t i=0; i < found[t].size; i += 3) {
+            ++offsets[found[t].items[i] + 1];
+        }
+    }
+    for (std::size_t v=0; v < n; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+    SearchEntry* buckets{new SearchEntry[offsets[n]]};  // here 'v' is the index of the target
+    std::size_t* next{new std::size_t[n]};
+    for (std::size_t v=0; v < n; ++v) {
+        next[v] = offsets[v];
+    }
+    for (std::size_t t=0; t < threads; ++t) {
+        for (std::size_t i=0; i < found[t].size; i += 3) {
+            buckets[next[found[t].items[i]]++] = SearchEntry{found[t].items[i + 2], found[t].items[i + 1]};
+        }
+    }
+    delete[] next;
+    delete[] found;
+    parallel_for(num_sources, threads, [&](const std::size_t i, const std::size_t t) {
+        DijkstraWorkspace& workspace = *workspaces[t];
+        int* row{table + i * num_targets};
+        for (std::size_t j=0; j < num_targets; ++j) {
+            row[j] = INT_MAX;
+        }
+        workspace.search(ch.graph(false), sources[i], [&](const int v) {
+            const long long d{workspace.distance(v)};
+            for (std::size_t b=offsets[v]; b < offsets[v + 1]; ++b) {
+                if (d + buckets[b].d < row[buckets[b].v]) {
+                    row[buckets[b].v] = static_cast<int>(d + buckets[b].d);
+                }
+            }
+            return true;
+        });
+    });
+    for (std::size_t t=0; t < threads; ++t) {
+        delete workspaces[t];
+    }
+    delete[] workspaces;
+    delete[] buckets;
+    delete[] offsets;
+}
+
+#endif  // __DISTANCE_TABLE__
@@ -0,0 +1,505 @@
+#ifndef __GRAPH_IO__
+#define __GRAPH_IO__
+
+/**
+  * This header file contains the loaders of graphs stored as text (DIMACS shortest path files, plain edge lists and
+  * Matrix Market files) and the binary snapshot format of CSRGraph. The text loaders map the file in memory and split
+  * it in as many chunks as threads, cut at line boundaries; each thread parses its chunk with a hand-written integer
+  * parser, without iostreams, into its own array of edges, and the arrays are then concatenated in file order and
+  * turned into a CSRGraph. A snapshot stores the arrays of a CSRGraph as they are in memory, so a later run can map
+  * the file and use them in place, without parsing or copying anything.
+  */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "graph_utilities.h"
+#include "csr_graph.h"
+
+#define SNAPSHOT_VERSION 1  // version of the snapshot format, to be bumped at every incompatible change
+#define SNAPSHOT_BYTE_ORDER 0x01020304u  // written in native byte order, to detect snapshots from other machines
+
+// print the error of a failed system call on 'path' and abort the program
+inline void io_fail(const char* what, const char* path) {
+    std::perror(what);
+    std::cout << "while accessing " << path << std::endl;
+    abort();
+}
+
+/**
+  * Read-only memory mapping of a whole file, released by the destructor
+  */
+struct MappedFile {
+    const char* data;  // first byte of the file, nullptr if the file is empty
+    std::size_t size;  // size of the file in bytes
+
+    explicit MappedFile(const char* path) : data{nullptr}, size{0} {
+        const int fd{open(path, O_RDONLY)};
+        if (fd == -1) {
+            io_fail("open", path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            io_fail("fstat", path);
+        }
+        size = info.st_size;
+        if (size > 0) {
+            void* address{mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)};
+            if (address == MAP_FAILED) {
+                io_fail("mmap", path);
+            }
+            // the text is read front to back by each thread
+            madvise(address, size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(address);
+        }
+        close(fd);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+        if (data != nullptr) {
+            munmap(const_cast<char*>(data), size);
+        }
+    }
+};
+
+/**
+  * Growable array of the edges parsed by one thread, which also keeps the largest vertex index seen
+  */
+struct EdgeBuffer {
+    Edge* edges;  // the edges, in file order
+    std::size_t size;  // number of edges
+    std::size_t capacity;  // number of edges 'edges' has room for
+    long long max_vertex;  // largest vertex index seen, -1 if none
+
+    EdgeBuffer() : edges{nullptr}, size{0}, capacity{0}, max_vertex{-1} {}
+    EdgeBuffer(const EdgeBuffer&) = delete;
+    EdgeBuffer& operator=(const EdgeBuffer&) = delete;
+    // append the edge, unless a vertex or the weight does not fit in an int or is negative; returns false if so,
+    // for the caller to report the line
+    bool push(const long long source, const long long target, const long long weight) {
+        if (source < 0 || source > INT_MAX || target < 0 || target > INT_MAX || weight < 0 || weight > INT_MAX) {
+            return false;
+        }
+        if (size == capacity) {
+            capacity = (capacity == 0) ? 1024 : 2 * capacity;
+            Edge* new_edges{new Edge[capacity]};
+            for (std::size_t i=0; i < size; ++i) {
+                new_edges[i] = edges[i];
+            }
+            delete[] edges;
+            edges = new_edges;
+        }
+        edges[size++] = Edge{static_cast<int>(source), static_cast<int>(target), static_cast<int>(weight)};
+        max_vertex = (source > max_vertex) ? source : max_vertex;
+        max_vertex = (target > max_vertex) ? target : max_vertex;
+        return true;
+    }
+    ~EdgeBuffer() {
+        delete[] edges;
+    }
+};
+
+/**
+  * Cursor over the text [p, end), with the few parsing primitives the formats need. Numbers never cross a
+  * line, so the functions stop at the newline
+  */
+struct Scanner {
+    const char* p;  // next character to read
+    const char* end;  // end of the text
+
+    // skip spaces, tabs and carriage returns, but not the newline
+    void skip_blanks() noexcept {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    }
+    // whether only blanks are left on the current line
+    bool at_line_end() noexcept {
+        skip_blanks();
+        return p == end || *p == '\n';
+    }
+    // move to the first character of the next line
+    void next_line() noexcept {
+        while (p < end && *p != '\n') ++p;
+        if (p < end) ++p;
+    }
+    // read a decimal integer with an optional sign into 'x'; returns false if there is none. Integers too long
+    // for a long long saturate at about 10^18, which is out of range for the loaders anyway
+    bool read_int(long long& x) noexcept {
+        skip_blanks();
+        const bool negative{p < end && *p == '-'};
+        if (p < end && (*p == '-' || *p == '+')) ++p;
+        if (p == end || *p < '0' || *p > '9') return false;
+        x = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            x = (x < 100000000000000000LL) ? 10 * x + (*p - '0') : x;
+            ++p;
+        }
+        x = negative ? -x : x;
+        return true;
+    }
+    // read a real number, like 12, -1.5 or 2.5e+03, into 'x'; returns false if there is none
+    bool read_real(double& x) noexcept {
+        skip_blanks();
+        const bool negative{p < end && *p == '-'};
+        if (p < end && (*p == '-' || *p == '+')) ++p;
+        bool digits{false};
+        x = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            x = 10 * x + (*p++ - '0');
+            digits = true;
+        }
+        if (p < end && *p == '.') {
+            ++p;
+            for (double scale=0.1; p < end && *p >= '0' && *p <= '9'; scale /= 10) {
+                x += scale * (*p++ - '0');
+                digits = true;
+            }
+        }
+        if (!digits) return false;
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            long long exponent{0};
+            if (!read_int(exponent)) return false;
+            // the loops stop once 'x' is out of range or zero, whatever the exponent
+            for (; exponent > 0 && x < 1e300; --exponent) x *= 10;
+            for (; exponent < 0 && x != 0; ++exponent) x /= 10;
+        }
+        x = negative ? -x : x;
+        return true;
+    }
+    // read a word (a run of non-blank characters) into 'word', of at most 'length' - 1 characters
+    void read_word(char* word, const std::size_t length) noexcept {
+        skip_blanks();
+        std::size_t i{0};
+        while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+            if (i + 1 < length) word[i++] = (*p >= 'A' && *p <= 'Z') ? *p - 'A' + 'a' : *p;
+            ++p;
+        }
+        word[i] = '\0';
+    }
+};
+
+// report the line starting at 'line', which the loader cannot understand, and abort the program. The text ends at 'end'
+inline void malformed(const char* line, const char* end) {
+    const char* stop{line};
+    while (stop < end && *stop != '\n' && stop - line < 80) ++stop;
+    std::cout << "malformed line in graph file: ";
+    std::cout.write(line, stop - line);
+    std::cout << std::endl;
+    abort();
+}
+
+/**
+  * Parse the lines of [begin, end) with 'threads' threads. Each thread gets a chunk of about the same size whose
+  * bounds are moved forward to the start of a line, and calls 'parse(scanner, buffer)' on every line starting in
+  * it: 'parse' reads the line from the scanner and pushes its edges, if any, to the buffer of the thread. The
+  * buffers are then concatenated in file order into a CSRGraph with at least 'min_vertices' vertices, which is
+  * returned and must be deleted by the caller. Zero threads are taken as one
+  */
+template<class Parse>
+CSRGraph* parse_edges(const char* begin, const char* end, std::size_t threads, const std::size_t min_vertices, Parse parse) {
+    threads = (threads > 0) ? threads : 1;
+    const std::size_t length{static_cast<std::size_t>(end - begin)};
+    EdgeBuffer* buffers{new EdgeBuffer[threads]};
+    std::thread* workers{new std::thread[threads]};
+    for (std::size_t t=0; t < threads; ++t) {
+        workers[t] = std::thread{[=]() {
+            // bounds of the chunk, moved to the start of the following line
+            const char* first{begin + t * length / threads};
+            const char* last{begin + (t + 1) * length / threads};
+            while (t > 0 && first < end && first[-1] != '\n') ++first;
+            while (t + 1 < threads && last < end && last[-1] != '\n') ++last;
+            Scanner s{first, last};
+            while (s.p < s.end) {
+                parse(s, buffers[t]);
+                s.next_line();
+            }
+        }};
+    }
+    std::size_t m{0};
+    long long max_vertex{-1};
+    for (std::size_t t=0; t < threads; ++t) {
+        workers[t].join();
+        m += buffers[t].size;
+        max_vertex = (buffers[t].max_vertex > max_vertex) ? buffers[t].max_vertex : max_vertex;
+    }
+    delete[] workers;
+    Edge* edges{new Edge[m]};
+    std::size_t i{0};
+    for (std::size_t t=0; t < threads; ++t) {
+        for (std::size_t e=0; e < buffers[t].size; ++e) {
+            edges[i++] = buffers[t].edges[e];
+        }
+    }
+    delete[] buffers;
+    const std::size_t n{static_cast<std::size_t>(max_vertex + 1) > min_vertices ? static_cast<std::size_t>(max_vertex + 1) : min_vertices};
+    CSRGraph* graph{new CSRGraph{edges, m, n}};
+    delete[] edges;
+    return graph;
+}
+
+/**
+  * Load a DIMACS shortest path file (.gr), as used by the 9th DIMACS challenge: comment lines start with 'c', the
+  * problem line 'p sp n m' gives the number of vertices and edges, and each arc line 'a u v w' an edge from u to v
+  * of weight w, with vertices numbered from 1. The graph must be deleted by the caller
+  */
+inline CSRGraph* load_dimacs(const char* path, const std::size_t threads=default_threads()) {
+    MappedFile file{path};
+    // find the problem line, which comes before the arcs
+    Scanner s{file.data, file.data + file.size};
+    long long n{-1};
+    long long m{0};
+    while (s.p < s.end && n < 0) {
+        const char* line{s.p};
+        if (*s.p == 'p') {
+            char word[16];
+            ++s.p;
+            s.read_word(word, sizeof(word));
+            if (std::strcmp(word, "sp") != 0 || !s.read_int(n) || !s.read_int(m) || n < 0) {
+                malformed(line, s.end);
+            }
+        }
+        else if (*s.p != 'c' && !s.at_line_end()) {
+            malformed(line, s.end);
+        }
+        s.next_line();
+    }
+    if (n < 0) {
+        std::cout << path << " has no problem line" << std::endl;
+        abort();
+    }
+    CSRGraph* graph{parse_edges(s.p, s.end, threads, n, [](Scanner& line, EdgeBuffer& edges) {
+        const char* start{line.p};
+        long long u, v, w;
+        if (*line.p == 'a') {
+            ++line.p;
+            if (!line.read_int(u) || !line.read_int(v) || !line.read_int(w) || !edges.push(u - 1, v - 1, w)) {
+                malformed(start, line.end);
+            }
+        }
+        else if (*line.p != 'c' && !line.at_line_end()) {
+            malformed(start, line.end);
+        }
+    })};
+    if (graph->n != static_cast<std::size_t>(n) || graph->m != static_cast<std::size_t>(m)) {
+        std::cout << path << " does not match its problem line" << std::endl;
+        abort();
+    }
+    return graph;
+}
+
+/**
+  * Load a plain edge list: one edge 'u v w' per line, separated by blanks, with vertices numbered from 0. The weight
+  * may be omitted, in which case it is 1; lines starting with '#' or '%' are comments. The number of vertices is one
+  * plus the largest index found. The graph must be deleted by the caller
+  */
+inline CSRGraph* load_edge_list(const char* path, const std::size_t threads=default_threads()) {
+    MappedFile file{path};
+    return parse_edges(file.data, file.data + file.size, threads, 0, [](Scanner& line, EdgeBuffer& edges) {
+        const char* start{line.p};
+        long long u, v, w{1};
+        if (line.at_line_end() || *line.p == '#' || *line.p == '%') {
+            return;
+        }
+        if (!line.read_int(u) || !line.read_int(v) || (!line.at_line_end() && !line.read_int(w)) || !edges.push(u, v, w)) {
+            malformed(start, line.end);
+        }
+    });
+}
+
+/**
+  * Load a Matrix Market file in coordinate format: the entry (i, j) of the matrix, numbered from 1, is an edge from
+  * i to j weighted by its value, rounded to the nearest integer ('pattern' matrices get weight 1). A symmetric
+  * matrix lists only one triangle, so each off-diagonal entry gives the edges in both directions. The graph, with
+  * as many vertices as the larger dimension of the matrix, must be deleted by the caller
+  */
+inline CSRGraph* load_matrix_market(const char* path, const std::size_t threads=default_threads()) {
+    MappedFile file{path};
+    Scanner s{file.data, file.data + file.size};
+    // banner: %%MatrixMarket matrix coordinate <integer|real|pattern> <general|symmetric>
+    char banner[32], object[32], format[32], field[32], symmetry[32];
+    s.read_word(banner, sizeof(banner));
+    s.read_word(object, sizeof(object));
+    s.read_word(format, sizeof(format));
+    s.read_word(field, sizeof(field));
+    s.read_word(symmetry, sizeof(symmetry));
+    const bool pattern{std::strcmp(field, "pattern") == 0};
+    const bool symmetric{std::strcmp(symmetry, "symmetric") == 0};
+    if (std::strcmp(banner, "%%matrixmarket") != 0 || std::strcmp(object, "matrix") != 0 || std::strcmp(format, "coordinate") != 0
+        || (!pattern && std::strcmp(field, "integer") != 0 && std::strcmp(field, "real") != 0)
+        || (!symmetric && std::strcmp(symmetry, "general") != 0)) {
+        std::cout << path << " is not a Matrix Market file of a supported kind" << std::endl;
+        abort();
+    }
+    s.next_line();
+    // skip the comments, then read the size line
+    while (s.p < s.end && (*s.p == '%' || s.at_line_end())) {
+        s.next_line();
+    }
+    long long rows, columns, entries;
+    const char* size_line{s.p};
+    if (!s.read_int(rows) || !s.read_int(columns) || !s.read_int(entries)) {
+        malformed(size_line, s.end);
+    }
+    s.next_line();
+    return parse_edges(s.p, s.end, threads, rows > columns ? rows : columns, [=](Scanner& line, EdgeBuffer& edges) {
+        const char* start{line.p};
+        long long i, j;
+        double value{1};
+        if (line.at_line_end() || *line.p == '%') {
+            return;
+        }
+        if (!line.read_int(i) || !line.read_int(j) || (!pattern && !line.read_real(value))) {
+            malformed(start, line.end);
+        }
+        // values beyond the range of an int are rejected by push rather than converted
+        const long long w{(value > INT_MAX || value < INT_MIN) ? LLONG_MAX : static_cast<long long>(value < 0 ? value - 0.5 : value + 0.5)};
+        if (!edges.push(i - 1, j - 1, w) || (symmetric && i != j && !edges.push(j - 1, i - 1, w))) {
+            malformed(start, line.end);
+        }
+    });
+}
+
+/**
+  * Header of a snapshot file. It is followed by the n + 1 offsets (64-bit), the m targets and the m weights
+  * (32-bit), exactly as they are laid out in the arrays of a CSRGraph on a 64-bit machine
+  */
+struct SnapshotHeader {
+    char magic[8];  // "CSRGRAPH"
+    std::uint32_t version;  // SNAPSHOT_VERSION of the program that wrote it
+    std::uint32_t byte_order;  // SNAPSHOT_BYTE_ORDER, in the byte order of the machine that wrote it
+    std::uint64_t n;  // number of vertices
+    std::uint64_t m;  // number of edges
+};
+
+// write the 'bytes' bytes of 'data' to 'fd', in as many calls as needed
+inline void write_all(const int fd, const void* data, std::size_t bytes, const char* path) {
+    const char* p{static_cast<const char*>(data)};
+    while (bytes > 0) {
+        const ssize_t written{write(fd, p, bytes)};
+        if (written <= 0) {
+            io_fail("write", path);
+        }
+        p += written;
+        bytes -= written;
+    }
+}
+
+/**
+  * Save 'graph' to the snapshot file 'path', to be mapped by GraphSnapshot
+  */
+inline void save_snapshot(const CSRGraph& graph, const char* path) {
+    static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "snapshots store the offsets as they are in memory");
+    const int fd{open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+    if (fd == -1) {
+        io_fail("open", path);
+    }
+    SnapshotHeader header;
+    std::memcpy(header.magic, "CSRGRAPH", sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.n = graph.n;
+    header.m = graph.m;
+    write_all(fd, &header, sizeof(header), path);
+    write_all(fd, graph.offsets, (graph.n + 1) * sizeof(std::size_t), path);
+    write_all(fd, graph.targets, graph.m * sizeof(int), path);
+    write_all(fd, graph.weights, graph.m * sizeof(int), path);
+    if (close(fd) != 0) {
+        io_fail("close", path);
+    }
+}
+
+/**
+  * A snapshot mapped in memory. The CSRGraph it exposes works directly on the pages of the file, which the
+  * operating system loads on first access and shares among the processes mapping the same snapshot, so opening
+  * even a huge graph takes little time. The mapping is private: writes to the graph never reach the file.
+  * A snapshot with a different version or byte order, or whose size does not match its header, aborts the program.
+  * Unless the file is trusted ('validate' false), the arrays are also checked in one O(n + m) pass, since a corrupted
+  * offset or target would make the algorithms read out of bounds: the offsets must go from 0 to m without
+  * decreasing, the targets must be vertices and the weights non-negative. This reads the whole file once; a trusted
+  * snapshot is mapped in constant time and its pages are only loaded on first access
+  */
+class GraphSnapshot {
+    void* base;  // the mapping
+    std::size_t bytes;  // length of the mapping
+    CSRGraph* csr;  // graph over the arrays in the mapping
+
+  public:
+    explicit GraphSnapshot(const char* path, const bool validate=true) : base{nullptr}, bytes{0}, csr{nullptr} {
+        const int fd{open(path, O_RDONLY)};
+        if (fd == -1) {
+            io_fail("open", path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            io_fail("fstat", path);
+        }
+        bytes = info.st_size;
+        if (bytes < sizeof(SnapshotHeader)) {
+            std::cout << path << " is not a graph snapshot" << std::endl;
+            abort();
+        }
+        base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) {
+            io_fail("mmap", path);
+        }
+        close(fd);
+        const SnapshotHeader* header{static_cast<const SnapshotHeader*>(base)};
+        if (std::memcmp(header->magic, "CSRGRAPH", sizeof(header->magic)) != 0) {
+            std::cout << path << " is not a graph snapshot" << std::endl;
+            abort();
+        }
+        if (header->version != SNAPSHOT_VERSION || header->byte_order != SNAPSHOT_BYTE_ORDER) {
+            std::cout << path << " has version " << header->version << " or byte order " << header->byte_order
+                      << ", expected " << SNAPSHOT_VERSION << " and " << SNAPSHOT_BYTE_ORDER << std::endl;
+            abort();
+        }
+        const std::size_t n{header->n};
+        const std::size_t m{header->m};
+        // the size expected from the header, computed so that huge values of n and m cannot overflow
+        const std::size_t payload{bytes - sizeof(SnapshotHeader)};
+        const bool sized{n <= INT_MAX && n < payload / sizeof(std::size_t)
+                         && m <= (payload - (n + 1) * sizeof(std::size_t)) / (2 * sizeof(int))
+                         && payload == (n + 1) * sizeof(std::size_t) + 2 * m * sizeof(int)};
+        if (!sized) {
+            std::cout << path << " is truncated or corrupted" << std::endl;
+            abort();
+        }
+        std::size_t* offsets{reinterpret_cast<std::size_t*>(static_cast<char*>(base) + sizeof(SnapshotHeader))};
+        int* targets{reinterpret_cast<int*>(offsets + n + 1)};
+        int* weights{targets + m};
+        bool valid{offsets[0] == 0 && offsets[n] == m};
+        for (std::size_t u=0; validate && valid && u < n; ++u) {
+            valid = offsets[u] <= offsets[u + 1];
+        }
+        for (std::size_t e=0; validate && valid && e < m; ++e) {
+            valid = targets[e] >= 0 && static_cast<std::size_t>(targets[e]) < n && weights[e] >= 0;
+        }
+        if (!valid) {
+            std::cout << path << " is truncated or corrupted" << std::endl;
+            abort();
+        }
+        csr = new CSRGraph{n, m, offsets, targets, weights};
+    }
+    GraphSnapshot(const GraphSnapshot&) = delete;
+    GraphSnapshot& operator=(const GraphSnapshot&) = delete;
+    // the graph, valid as long as the snapshot
+    const CSRGraph& graph() const noexcept {
+        return *csr;
+    }
+    ~GraphSnapshot() {
+        delete csr;
+        munmap(base, bytes);
+    }
+};
+
+#endif  // __GRAPH_IO__
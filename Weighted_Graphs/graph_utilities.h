@@ -2,11 +2,17 @@
 #define __GRAPH_UTIL__
 
 /**
-  * This header file includes structs and classes used by the Dijkstra's algorithm implementation of dijkstra.cc
+  * This header file includes structs and classes used by the Dijkstra's algorithm implementation of dijkstra.cc,
+  * and the helpers shared by the other headers: the search entries, the vertex lists and the threading helpers
   */
 
 #include <iostream>
-#include <math.h> // for INT_MAX
+#include <climits> // for INT_MAX
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 
 /**
@@ -24,14 +30,13 @@ struct Vertex {
     // Default constructor
     Vertex() = default;
     // Constructs a node from a given index 'idx'. Notice all the nodes are assumed to be on the queue at the beginning
-    Vertex(const int idx) : index{idx}, d{INT_MAX}, pred{-1}, on_queue{true} {}
+    explicit Vertex(const int idx) : index{idx}, d{INT_MAX}, pred{-1}, on_queue{true} {}
     // Default destructor
     ~Vertex() = default;
 };
 
 /**
-  * Function object for Vertex comparisons. Notice the overloads of the operator() allow us to compare two
-  * instances of Vertex, or a Vertex with an integer. All comparisons are based on the member 'd', the distance.
+  * Function object for Vertex comparisons. All comparisons are based on the member 'd', the distance.
   * To be passed as a template parameter to the BinaryHeap in Dijkstra's algorithm.
   */
 struct CompareVertex {
@@ -39,12 +44,182 @@ struct CompareVertex {
     bool operator()(const Vertex& a, const Vertex& b) const noexcept {
         return a.d < b.d;
     }
-    bool operator()(const Vertex& vertex, const int value) const noexcept {
-        return vertex.d < value;
-    }
     ~CompareVertex() = default;
 };
 
+/**
+  * Function object returning the handle of a Vertex, which is simply its index. To be passed as a template
+  * parameter to the BinaryHeap in Dijkstra's algorithm, so that the heap can locate a vertex to decrease its key.
+  */
+struct VertexHandle {
+    VertexHandle() = default;
+    std::size_t operator()(const Vertex& v) const noexcept {
+        return v.index;
+    }
+    ~VertexHandle() = default;
+};
+
+/**
+  * The vertices of a search laid out as a structure of arrays, for large graphs: the distances are a dense array, the
+  * predecessors another, and whether each vertex is still on the queue is one bit of a bitset. The relaxation step
+  * only reads the distance and the bit of a neighbor, 4 bytes and a bit instead of the 16 bytes of a Vertex, and
+  * writes its predecessor only when the distance decreases. The index of a vertex is its position in the arrays.
+  * Queues built from a store (Queue, RadixHeap, DialQueue) copy the distances they need as keys, and are given the
+  * new distance of a vertex by decrease(i, d)
+  */
+struct VertexStore {
+    std::size_t n;  // number of vertices
+    int* d;  // distance of each vertex
+    int* pred;  // predecessor of each vertex in the shortest-paths tree, -1 if none
+    std::uint64_t* queued;  // bit v % 64 of word v / 64 is set if vertex v is still on the queue
+
+    // Constructor, builds a store for 'num_vertices' vertices, all on the queue at infinite distance
+    explicit VertexStore(const std::size_t num_vertices) :
+        n{num_vertices}, d{new int[num_vertices]}, pred{new int[num_vertices]}, queued{new std::uint64_t[num_vertices / 64 + 1]} {
+        reset();
+    }
+    VertexStore(const VertexStore&) = delete;
+    VertexStore& operator=(const VertexStore&) = delete;
+    // put every vertex back on the queue at infinite distance, with plain loops the compiler can vectorize
+    void reset() noexcept {
+        for (std::size_t v=0; v < n; ++v) {
+            d[v] = INT_MAX;
+        }
+        for (std::size_t v=0; v < n; ++v) {
+            pred[v] = -1;
+        }
+        for (std::size_t w=0; w <= n / 64; ++w) {
+            queued[w] = ~0ULL;
+        }
+    }
+    bool on_queue(const std::size_t v) const noexcept {
+        return (queued[v / 64] >> (v % 64)) & 1;
+    }
+    // take 'v' off the queue
+    void settle(const std::size_t v) noexcept {
+        queued[v / 64] &= ~(1ULL << (v % 64));
+    }
+    // Destructor
+    ~VertexStore() {
+        delete[] d;
+        delete[] pred;
+        delete[] queued;
+    }
+};
+
+/**
+  * Growable array of vertex indices
+  */
+struct VertexList {
+    int* items;
+    std::size_t size;
+    std::size_t capacity;
+
+    VertexList() : items{nullptr}, size{0}, capacity{0} {}
+    VertexList(const VertexList&) = delete;
+    VertexList& operator=(const VertexList&) = delete;
+    void push(const int v) {
+        if (size == capacity) {
+            capacity = (capacity == 0) ? 64 : 2 * capacity;
+            int* new_items{new int[capacity]};
+            for (std::size_t i=0; i < size; ++i) {
+                new_items[i] = items[i];
+            }
+            delete[] items;
+            items = new_items;
+        }
+        items[size++] = v;
+    }
+    ~VertexList() {
+        delete[] items;
+    }
+};
+
+/**
+  * Entry of the queue of a search with lazy deletion: a vertex and the distance it had when it was pushed. When the
+  * distance of a vertex decreases it is simply pushed again, and the outdated entries are skipped when popped
+  */
+struct SearchEntry {
+    int d;  // distance of the vertex when pushed
+    int v;  // the vertex
+};
+
+struct CompareEntries {
+    bool operator()(const SearchEntry& a, const SearchEntry& b) const noexcept {
+        return a.d < b.d;
+    }
+};
+
+// default number of threads of the parallel algorithms and of the loaders: one per core
+inline std::size_t default_threads() {
+    const std::size_t threads{std::thread::hardware_concurrency()};
+    return threads > 0 ? threads : 1;
+}
+
+/**
+  * Run 'work(t)' on 'threads' threads, for each t from 0 to 'threads' - 1, and wait for all of them; the calling
+  * thread runs it as thread 0. Zero threads are taken as one
+  */
+template<class Work>
+void run_threads(std::size_t threads, Work work) {
+    threads = (threads > 0) ? threads : 1;
+    std::thread* workers{new std::thread[threads - 1]};
+    for (std::size_t t=1; t < threads; ++t) {
+        workers[t - 1] = std::thread{work, t};
+    }
+    work(0);
+    for (std::size_t t=1; t < threads; ++t) {
+        workers[t - 1].join();
+    }
+    delete[] workers;
+}
+
+/**
+  * Run 'body(i, t)' for each i from 0 to 'count' - 1 on 'threads' threads, t being the index of the thread running it.
+  * The indices are handed out in chunks from a shared counter, so the threads balance the load among themselves;
+  * the calling thread takes part as thread 0. Zero threads are taken as one
+  */
+template<class Body>
+void parallel_for(const std::size_t count, std::size_t threads, Body body) {
+    threads = (threads > 0) ? threads : 1;
+    const std::size_t chunk{count / (8 * threads) + 1};
+    std::atomic<std::size_t> next{0};
+    run_threads(threads, [&](const std::size_t t) {
+        for (std::size_t lo=next.fetch_add(chunk); lo < count; lo = next.fetch_add(chunk)) {
+            const std::size_t hi{lo + chunk < count ? lo + chunk : count};
+            for (std::size_t i=lo; i < hi; ++i) {
+                body(i, t);
+            }
+        }
+    });
+}
+
+/**
+  * Reusable barrier for a fixed number of threads: 'wait' returns once all of them have called it
+  */
+class Barrier {
+    std::mutex lock;
+    std::condition_variable all_arrived;
+    std::size_t threads;  // number of threads to wait for
+    std::size_t arrived;  // number of threads waiting in the current round
+    std::size_t round;  // number of rounds completed
+
+  public:
+    explicit Barrier(const std::size_t n) : threads{n}, arrived{0}, round{0} {}
+    void wait() {
+        std::unique_lock<std::mutex> guard{lock};
+        const std::size_t current{round};
+        if (++arrived == threads) {
+            arrived = 0;
+            ++round;
+            all_arrived.notify_all();
+        }
+        else {
+            all_arrived.wait(guard, [&] {return round != current;});
+        }
+    }
+};
+
 /**
   * Queue data structure implementation using arrays. It keeps an internal array of data,
   * which can be manipulated using the extract_min and operator[] functions. This
@@ -67,6 +242,12 @@ class Queue {
             data[i] = graph[i].d;
         }
     }
+    // Constructor, builds a queue from the distances of the vertices in 'store', all of which must be on the queue
+    explicit Queue(const VertexStore& store) : size{store.n}, free_slots{0}, num{store.n}, data{new int[size]} {
+        for (std::size_t i=0; i < size; ++i) {
+            data[i] = store.d[i];
+        }
+    }
     // Tests whether the queue does not contain any element
     bool is_empty() const noexcept {
         return num == 0;
@@ -90,10 +271,14 @@ class Queue {
         ++free_slots;
         return index;
     }
-    // Update the value of data[i] to 'value', just like
+    // Update the value of data[i] to the distance of 'v', the vertex of index i, just like
     // UPDATE_DISTANCE
-    void decrease(const std::size_t i, const int value) {
-        data[i] = value;
+    void decrease(const std::size_t i, const Vertex& v) {
+        data[i] = v.d;
+    }
+    // Same, given the new distance 'd'
+    void decrease(const std::size_t i, const int d) {
+        data[i] = d;
     }
     // Destructor
     ~Queue() {
@@ -101,4 +286,367 @@ class Queue {
     }
 };
 
+/**
+  * Monotone radix heap of vertices keyed by distance. It relies on two properties of Dijkstra's algorithm:
+  * distances are non-negative integers, and the keys extracted never decrease. The vertices are spread over
+  * 33 buckets: bucket 0 holds the keys equal to the last extracted key 'last', and bucket b > 0 the keys
+  * whose highest bit differing from 'last' is bit b - 1. EXTRACT_MIN pops from bucket 0 when it can; otherwise
+  * it takes the first non-empty bucket, finds its minimum, makes it the new 'last' and redistributes the bucket,
+  * whose keys all fall into lower buckets. Every key can only move down, at most 32 times, so both EXTRACT_MIN and
+  * DECREASE cost O(log C) amortized, where C is the largest distance, with no comparisons between keys
+  * other than the scan of the redistributed bucket. Buckets are doubly-linked lists threaded through
+  * arrays indexed by vertex, so no allocation happens after the constructor.
+  */
+class RadixHeap {
+    static const int NUM_BUCKETS = 33;  // one per possible highest differing bit of a 32-bit key, plus bucket 0
+    std::size_t num;  // number of vertices still in the heap
+    unsigned last;  // last extracted key
+    unsigned* key;  // key of each vertex
+    int* bucket;  // bucket of each vertex
+    int* next;  // next vertex in the same bucket, -1 if none
+    int* prev;  // previous vertex in the same bucket, -1 if none
+    int head[NUM_BUCKETS];  // first vertex of each bucket, -1 if empty
+    unsigned long long non_empty;  // bit b is set if bucket b is not empty
+
+    // bucket of a key 'k' with respect to 'last': one plus the index of the highest differing bit
+    int bucket_of(const unsigned k) const noexcept {
+        return k == last ? 0 : 32 - __builtin_clz(k ^ last);
+    }
+    // push vertex 'i' in front of bucket 'b'
+    void insert(const int i, const int b) noexcept {
+        bucket[i] = b;
+        prev[i] = -1;
+        next[i] = head[b];
+        if (head[b] != -1) {
+            prev[head[b]] = i;
+        }
+        head[b] = i;
+        non_empty |= 1ULL << b;
+    }
+    // unlink vertex 'i' from its bucket
+    void remove(const int i) noexcept {
+        const int b{bucket[i]};
+        if (prev[i] != -1) {
+            next[prev[i]] = next[i];
+        }
+        else {
+            head[b] = next[i];
+        }
+        if (next[i] != -1) {
+            prev[next[i]] = prev[i];
+        }
+        if (head[b] == -1) {
+            non_empty &= ~(1ULL << b);
+        }
+    }
+
+  public:
+    // Constructor, builds the heap from the distances of the 'n' vertices in 'graph'. Equivalent to BUILD_QUEUE.
+    // The vertices no longer on the queue are left out, so the heap can take over a search already under way
+    RadixHeap(Vertex graph[], const std::size_t n) : num{0}, last{0}, key{new unsigned[n]}, bucket{new int[n]},
+                                                     next{new int[n]}, prev{new int[n]}, head{}, non_empty{0} {
+        for (int b=0; b < NUM_BUCKETS; ++b) {
+            head[b] = -1;
+        }
+        for (std::size_t i=0; i < n; ++i) {
+            if (graph[i].on_queue) {
+                key[i] = graph[i].d;
+                insert(i, bucket_of(key[i]));
+                ++num;
+            }
+        }
+    }
+    // Constructor, builds the heap from the distances of the vertices on the queue in 'store'
+    explicit RadixHeap(const VertexStore& store) : num{0}, last{0}, key{new unsigned[store.n]}, bucket{new int[store.n]},
+                                                   next{new int[store.n]}, prev{new int[store.n]}, head{}, non_empty{0} {
+        for (int b=0; b < NUM_BUCKETS; ++b) {
+            head[b] = -1;
+        }
+        for (std::size_t i=0; i < store.n; ++i) {
+            if (store.on_queue(i)) {
+                key[i] = store.d[i];
+                insert(i, bucket_of(key[i]));
+                ++num;
+            }
+        }
+    }
+    // Constructor, builds an empty heap for vertices 0 to 'n' - 1, to be filled by push
+    explicit RadixHeap(const std::size_t n) : num{0}, last{0}, key{new unsigned[n]}, bucket{new int[n]}, next{new int[n]},
+                                              prev{new int[n]}, head{}, non_empty{0} {
+        for (int b=0; b < NUM_BUCKETS; ++b) {
+            head[b] = -1;
+        }
+    }
+    RadixHeap(const RadixHeap&) = delete;
+    RadixHeap& operator=(const RadixHeap&) = delete;
+    // Tests whether the heap does not contain any element
+    bool is_empty() const noexcept {
+        return num == 0;
+    }
+    // Adds vertex 'i', which is not in the heap, with distance 'd'
+    void push(const std::size_t i, const int d) {
+        key[i] = d;
+        insert(i, bucket_of(key[i]));
+        ++num;
+    }
+    // Removes a vertex of minimum distance and returns its index
+    std::size_t extract_min() noexcept {
+        if (head[0] == -1) {
+            // the first non-empty bucket holds the minimum: make it the new 'last' and redistribute
+            // the bucket, whose elements all land in lower buckets
+            const int b{__builtin_ctzll(non_empty)};
+            unsigned minimum{key[head[b]]};
+            for (int i=next[head[b]]; i != -1; i = next[i]) {
+                minimum = key[i] < minimum ? key[i] : minimum;
+            }
+            last = minimum;
+            int i{head[b]};
+            head[b] = -1;
+            non_empty &= ~(1ULL << b);
+            while (i != -1) {
+                const int following{next[i]};
+                insert(i, bucket_of(key[i]));
+                i = following;
+            }
+        }
+        const int ans{head[0]};
+        remove(ans);
+        --num;
+        return ans;
+    }
+    // Update the key of vertex i to the distance of 'v', which cannot be smaller than the last extracted key
+    void decrease(const std::size_t i, const Vertex& v) {
+        decrease(i, v.d);
+    }
+    // Same, given the new distance 'd'
+    void decrease(const std::size_t i, const int d) {
+        remove(i);
+        key[i] = d;
+        insert(i, bucket_of(key[i]));
+    }
+    // Destructor
+    ~RadixHeap() {
+        delete[] key;
+        delete[] bucket;
+        delete[] next;
+        delete[] prev;
+    }
+};
+
+#define DIAL_MAX_BUCKETS 65536  // largest bucket array of a DialQueue, beyond which it falls back to a RadixHeap
+
+/**
+  * Bucket queue of vertices keyed by distance, as in Dial's algorithm. Like the RadixHeap, it relies on the keys
+  * extracted never decreasing; moreover, when the edge weights are at most C, all the finite keys in the queue lie
+  * between the last extracted key 'last' and last + C. A circular array of more than C buckets, indexed by key modulo
+  * its size, thus holds each key in its own bucket: DECREASE moves a vertex to another bucket in O(1), and EXTRACT_MIN
+  * walks forward from the bucket of 'last' to the first non-empty one, which costs O(C) at worst but O(1) amortized
+  * over a search whose distances are dense. The queue does not know C beforehand: the array starts with 'max_weight'
+  * + 1 buckets, rounded up to a power of two, and doubles whenever a key does not fit, so in dijkstra it settles on
+  * the largest weight of the graph. If it would outgrow DIAL_MAX_BUCKETS, the queue hands its vertices over to a
+  * RadixHeap. The vertices at infinite distance stay out of the buckets, and are only extracted once the
+  * buckets are empty. Buckets are doubly-linked lists threaded through arrays indexed by vertex, as in RadixHeap
+  */
+class DialQueue {
+    std::size_t n;  // number of vertices
+    std::size_t num;  // number of vertices still in the queue
+    std::size_t finite;  // number of those at a finite distance, which are in the buckets
+    std::size_t infinite;  // the vertices at infinite distance before this one have all been extracted
+    unsigned last;  // last extracted key
+    unsigned mask;  // number of buckets minus one
+    unsigned* key;  // key of each vertex
+    char* state;  // 0 if a vertex is on the queue at infinite distance, 1 if it is in a bucket, 2 if extracted
+    int* next;  // next vertex in the same bucket, -1 if none
+    int* prev;  // previous vertex in the same bucket, -1 if none
+    int* head;  // first vertex of each bucket, -1 if empty
+    RadixHeap* fallback;  // the heap the vertices have been handed over to, nullptr if none
+
+    // push vertex 'i' in front of its bucket
+    void insert(const int i) noexcept {
+        const unsigned b{key[i] & mask};
+        state[i] = 1;
+        prev[i] = -1;
+        next[i] = head[b];
+        if (head[b] != -1) {
+            prev[head[b]] = i;
+        }
+        head[b] = i;
+    }
+    // unlink vertex 'i' from its bucket
+    void remove(const int i) noexcept {
+        if (prev[i] != -1) {
+            next[prev[i]] = next[i];
+        }
+        else {
+            head[key[i] & mask] = next[i];
+        }
+        if (next[i] != -1) {
+            prev[next[i]] = prev[i];
+        }
+    }
+    // make room for keys up to 'last' + 'span', doubling the buckets as many times as needed; returns false if that
+    // would take more than DIAL_MAX_BUCKETS buckets, in which case the array is left as it is
+    bool fit(const unsigned span) {
+        if (span <= mask) {
+            return true;
+        }
+        unsigned size{2 * (mask + 1)};
+        while (size <= span && size <= DIAL_MAX_BUCKETS) {
+            size *= 2;
+        }
+        if (size > DIAL_MAX_BUCKETS) {
+            return false;
+        }
+        // gather the vertices of the old buckets, then spread them over the new ones
+        int chain{-1};
+        for (unsigned b=0; b <= mask; ++b) {
+            for (int i=head[b], following; i != -1; i = following) {
+                following = next[i];
+                next[i] = chain;
+                chain = i;
+            }
+        }
+        delete[] head;
+        head = new int[size];
+        mask = size - 1;
+        for (unsigned b=0; b <= mask; ++b) {
+            head[b] = -1;
+        }
+        for (int i=chain, following; i != -1; i = following) {
+            following = next[i];
+            insert(i);
+        }
+        return true;
+    }
+    // hand the vertices over to a RadixHeap, for weights too large for the buckets; those outside the buckets still
+    // have their key INT_MAX, or their initial distance if the buckets are being built
+    void fall_back() {
+        fallback = new RadixHeap{n};
+        for (std::size_t i=0; i < n; ++i) {
+            if (state[i] != 2) {
+                fallback->push(i, key[i]);
+            }
+        }
+        delete[] key;
+        delete[] state;
+        delete[] next;
+        delete[] prev;
+        delete[] head;
+        key = nullptr;
+        state = nullptr;
+        next = prev = head = nullptr;
+    }
+    // fill the buckets with the vertices whose key and state have been set, with room for weights up to 'max_weight'
+    void build(const unsigned max_weight) {
+        head[0] = -1;
+        // the first key to come out is the smallest finite one
+        last = UINT_MAX;
+        for (std::size_t i=0; i < n; ++i) {
+            if (state[i] == 0 && key[i] != INT_MAX && key[i] < last) {
+                last = key[i];
+            }
+        }
+        last = (last == UINT_MAX) ? 0 : last;
+        unsigned span{max_weight};
+        for (std::size_t i=0; i < n; ++i) {
+            span = (state[i] == 0 && key[i] != INT_MAX && key[i] - last > span) ? key[i] - last : span;
+        }
+        if (!fit(span)) {
+            fall_back();
+            return;
+        }
+        for (std::size_t i=0; i < n; ++i) {
+            if (state[i] == 0 && key[i] != INT_MAX) {
+                insert(i);
+                ++finite;
+            }
+        }
+    }
+
+  public:
+    // Constructor, builds the queue from the distances of the vertices on the queue among the 'n' vertices in
+    // 'graph', with room for weights up to 'max_weight' before the buckets grow. Equivalent to BUILD_QUEUE.
+    DialQueue(Vertex graph[], const std::size_t num_vertices, const unsigned max_weight=0) :
+        n{num_vertices}, num{0}, finite{0}, infinite{0}, last{0}, mask{0}, key{new unsigned[n]},
+        state{new char[n]}, next{new int[n]}, prev{new int[n]}, head{new int[1]}, fallback{nullptr} {
+        for (std::size_t i=0; i < n; ++i) {
+            key[i] = graph[i].d;
+            state[i] = graph[i].on_queue ? 0 : 2;
+            num += graph[i].on_queue;
+        }
+        build(max_weight);
+    }
+    // Constructor, builds the queue from the distances of the vertices on the queue in 'store'
+    explicit DialQueue(const VertexStore& store, const unsigned max_weight=0) :
+        n{store.n}, num{0}, finite{0}, infinite{0}, last{0}, mask{0}, key{new unsigned[n]}, state{new char[n]},
+        next{new int[n]}, prev{new int[n]}, head{new int[1]}, fallback{nullptr} {
+        for (std::size_t i=0; i < n; ++i) {
+            key[i] = store.d[i];
+            state[i] = store.on_queue(i) ? 0 : 2;
+            num += store.on_queue(i);
+        }
+        build(max_weight);
+    }
+    DialQueue(const DialQueue&) = delete;
+    DialQueue& operator=(const DialQueue&) = delete;
+    // Tests whether the queue does not contain any element
+    bool is_empty() const noexcept {
+        return fallback != nullptr ? fallback->is_empty() : num == 0;
+    }
+    // Removes a vertex of minimum distance and returns its index
+    std::size_t extract_min() noexcept {
+        if (fallback != nullptr) {
+            return fallback->extract_min();
+        }
+        --num;
+        if (finite == 0) {
+            // only vertices at infinite distance are left
+            while (state[infinite] != 0) {
+                ++infinite;
+            }
+            state[infinite] = 2;
+            return infinite;
+        }
+        while (head[last & mask] == -1) {
+            ++last;
+        }
+        const int ans{head[last & mask]};
+        remove(ans);
+        state[ans] = 2;
+        --finite;
+        return ans;
+    }
+    // Update the key of vertex i to the distance of 'v', which cannot be smaller than the last extracted key
+    void decrease(const std::size_t i, const Vertex& v) {
+        decrease(i, v.d);
+    }
+    // Same, given the new distance 'd'
+    void decrease(const std::size_t i, const int d) {
+        if (fallback == nullptr && !fit(static_cast<unsigned>(d) - last)) {
+            fall_back();
+        }
+        if (fallback != nullptr) {
+            fallback->decrease(i, d);
+            return;
+        }
+        if (state[i] == 1) {
+            remove(i);
+        }
+        else {
+            ++finite;
+        }
+        key[i] = d;
+        insert(i);
+    }
+    // Destructor
+    ~DialQueue() {
+        delete[] key;
+        delete[] state;
+        delete[] next;
+        delete[] prev;
+        delete[] head;
+        delete fallback;
+    }
+};
+
 #endif  // __GRAPH_UTIL__
@@ -0,0 +1,278 @@
+#ifndef __HEURISTICS__
+#define __HEURISTICS__
+
+/**
+  * This header file contains the heuristics of the A* search of point_to_point.h: lower bounds on the distance
+  * between two vertices, either from their coordinates (GeometricHeuristic) or from the precomputed distances to
+  * and from a few landmark vertices (Landmarks, the ALT heuristic of Goldberg and Harrelson). All of them are
+  * consistent, so astar with any of them finds shortest paths
+  */
+
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "graph_utilities.h"
+#include "csr_graph.h"
+#include "graph_io.h"
+#include "delta_stepping.h"
+#include "dijkstra_workspace.h"
+
+#define LANDMARKS_VERSION 1  // version of the landmark cache format, to be bumped at every incompatible change
+
+/**
+  * Straight-line distance between points of the plane
+  */
+struct EuclideanMetric {
+    double operator()(const double x1, const double y1, const double x2, const double y2) const noexcept {
+        return std::hypot(x2 - x1, y2 - y1);
+    }
+};
+
+/**
+  * Great-circle distance in meters between points of the Earth, given as latitude and longitude in degrees
+  */
+struct HaversineMetric {
+    double operator()(const double lat1, const double lon1, const double lat2, const double lon2) const noexcept {
+        const double radians{M_PI / 180};
+        const double a{std::pow(std::sin((lat2 - lat1) * radians / 2), 2)
+                       + std::cos(lat1 * radians) * std::cos(lat2 * radians) * std::pow(std::sin((lon2 - lon1) * radians / 2), 2)};
+        return 2 * 6371000.0 * std::asin(std::sqrt(a < 1 ? a : 1));
+    }
+};
+
+/**
+  * Heuristic from the coordinates of the vertices: the distance between v and t according to 'Metric', times a
+  * scale factor turning it into a lower bound on the weights. The factor is the smallest ratio between the weight
+  * of an edge and the distance between its endpoints, computed by the constructor in O(m), so no edge is shorter
+  * than its scaled distance; by the triangle inequality of the metric, the heuristic is then consistent. The
+  * factor is shrunk by a tiny margin, so that rounding errors cannot make it larger than that
+  */
+template<class Metric>
+class GeometricHeuristic {
+    const double* x;  // first coordinate of each vertex (the latitude for HaversineMetric)
+    const double* y;  // second coordinate of each vertex (the longitude for HaversineMetric)
+    double scale;  // weight per unit of distance
+    Metric metric;  // the distance between points
+
+  public:
+    // Constructor, for 'graph' with vertex v at (xs[v], ys[v]); the coordinates are not copied, and must outlive
+    // the heuristic
+    GeometricHeuristic(const CSRGraph& graph, const double* xs, const double* ys) : x{xs}, y{ys}, scale{INFINITY}, metric{} {
+        for (std::size_t u=0; u < graph.n; ++u) {
+            for (std::size_t e=graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+                const int v{graph.targets[e]};
+                const double length{metric(x[u], y[u], x[v], y[v])};
+                if (length > 0 && graph.weights[e] < scale * length) {
+                    scale = graph.weights[e] / length;
+                }
+            }
+        }
+        scale = std::isinf(scale) ? 0 : scale * (1 - 1e-9);
+    }
+    int operator()(const int v, const int t) const noexcept {
+        const double bound{scale * metric(x[v], y[v], x[t], y[t])};
+        return bound < INT_MAX ? static_cast<int>(bound) : INT_MAX - 1;
+    }
+};
+
+/**
+  * Header of the cache file of Landmarks, followed by the landmarks and the two tables
+  */
+struct LandmarksHeader {
+    char magic[8];  // "LANDMARK"
+    std::uint32_t version;  // LANDMARKS_VERSION of the program that wrote it
+    std::uint32_t byte_order;  // SNAPSHOT_BYTE_ORDER, in the byte order of the machine that wrote it
+    std::uint64_t n;  // number of vertices of the graph
+    std::uint64_t m;  // number of edges of the graph
+    std::uint64_t k;  // number of landmarks
+    std::uint64_t fingerprint;  // hash of the graph, see graph_fingerprint
+};
+
+/**
+  * FNV-1a hash of the arrays of 'graph', to tell whether a cache file has been computed for the same graph
+  */
+inline std::uint64_t graph_fingerprint(const CSRGraph& graph) {
+    std::uint64_t hash{14695981039346656037ull};
+    const auto mix = [&hash](const std::uint64_t x) {hash = (hash ^ x) * 1099511628211ull;};
+    for (std::size_t u=0; u <= graph.n; ++u) {
+        mix(graph.offsets[u]);
+    }
+    for (std::size_t e=0; e < graph.m; ++e) {
+        mix((static_cast<std::uint64_t>(graph.targets[e]) << 32) | static_cast<std::uint32_t>(graph.weights[e]));
+    }
+    return hash;
+}
+
+/**
+  * The ALT heuristic. For k landmark vertices L, it keeps the distances d(L, v) from each landmark and d(v, L) to
+  * each landmark, for every vertex v. By the triangle inequality, both d(L, t) - d(L, v) and d(v, L) - d(t, L) are
+  * lower bounds on d(v, t), and the heuristic is the largest of them over all the landmarks; each bound is
+  * consistent, so their maximum is too. Bounds with an unreachable term are skipped. The landmarks are chosen with
+  * the farthest selection: each one is the vertex farthest from the landmarks chosen so far, so they end up on the
+  * border of the graph, behind the vertices, where the bounds are tight. The distances from the landmarks are
+  * computed one landmark at a time, since each choice depends on them, with delta-stepping on all the threads in a
+  * single array of vertices; the distances to the landmarks are then computed on the reverse graph, one landmark per
+  * thread at a time, each thread reusing its own DijkstraWorkspace.
+  * The tables take 8k bytes per vertex, stored by vertex so that a query reads one or two cache lines per vertex.
+  * Preprocessing costs 2k shortest path computations; the result can be cached on disk, and is then reloaded by
+  * later runs on the same graph.
+  */
+class Landmarks {
+    std::size_t n;  // number of vertices
+    std::size_t k;  // number of landmarks
+    int* landmarks;  // the landmarks
+    int* from;  // from[v * k + i] is the distance from landmark i to v, INT_MAX if v cannot be reached
+    int* to;  // to[v * k + i] is the distance from v to landmark i, INT_MAX if landmark i cannot be reached
+
+    // run delta-stepping from 'source' on 'graph' with 'threads' threads, and store the distances in column
+    // 'column' of 'table'; 'V' has room for graph.n vertices
+    void fill(const CSRGraph& graph, const int source, Vertex V[], int* table, const std::size_t column, const std::size_t threads) {
+        for (std::size_t v=0; v < n; ++v) {
+            V[v] = Vertex{static_cast<int>(v)};
+        }
+        delta_stepping(graph, V, V[source], threads);
+        for (std::size_t v=0; v < n; ++v) {
+            table[v * k + column] = V[v].d;
+        }
+    }
+    // choose the landmarks and compute the tables
+    void compute(const CSRGraph& graph, const CSRGraph& reverse, const std::size_t threads) {
+        Vertex* V = new Vertex[n];
+        // the first landmark is the vertex farthest from vertex 0, each next one the vertex whose nearest
+        // landmark is the farthest; vertices not reached by any landmark yet come first
+        long long* nearest = new long long[n];
+        fill(graph, 0, V, from, 0, threads);
+        for (std::size_t v=0; v < n; ++v) {
+            nearest[v] = from[v * k];
+        }
+        for (std::size_t i=0; i < k; ++i) {
+            std::size_t farthest{0};
+            for (std::size_t v=1; v < n; ++v) {
+                farthest = (nearest[v] > nearest[farthest]) ? v : farthest;
+            }
+            landmarks[i] = farthest;
+            fill(graph, landmarks[i], V, from, i, threads);
+            // the table of the first landmark started as the one of vertex 0
+            for (std::size_t v=0; v < n; ++v) {
+                nearest[v] = (i == 0 || from[v * k + i] < nearest[v]) ? from[v * k + i] : nearest[v];
+            }
+        }
+        delete[] nearest;
+        delete[] V;
+        // the distances to the landmarks, independent of each other, with one reusable workspace per thread
+        DijkstraWorkspace** workspaces{new DijkstraWorkspace*[threads]};
+        for (std::size_t t=0; t < threads; ++t) {
+            workspaces[t] = new DijkstraWorkspace{n};
+        }
+        parallel_for(k, threads, [&](const std::size_t i, const std::size_t t) {
+            dijkstra(reverse, landmarks[i], *workspaces[t]);
+            for (std::size_t v=0; v < n; ++v) {
+                to[v * k + i] = workspaces[t]->distance(v);
+            }
+        });
+        for (std::size_t t=0; t < threads; ++t) {
+            delete workspaces[t];
+        }
+        delete[] workspaces;
+    }
+    // read the landmarks and the tables from the cache file 'path'; returns false, leaving them untouched, if the
+    // file does not exist or has been computed for another graph, another number of landmarks or another version
+    bool load(const char* path, const CSRGraph& graph) {
+        if (access(path, F_OK) != 0) {
+            return false;
+        }
+        const MappedFile file{path};
+        LandmarksHeader header;
+        if (file.size < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, file.data, sizeof(header));
+        if (std::memcmp(header.magic, "LANDMARK", sizeof(header.magic)) != 0 || header.version != LANDMARKS_VERSION
+            || header.byte_order != SNAPSHOT_BYTE_ORDER || header.n != n || header.m != graph.m || header.k != k
+            || file.size != sizeof(header) + (1 + 2 * n) * k * sizeof(int) || header.fingerprint != graph_fingerprint(graph)) {
+            return false;
+        }
+        const char* p{file.data + sizeof(header)};
+        std::memcpy(landmarks, p, k * sizeof(int));
+        std::memcpy(from, p + k * sizeof(int), n * k * sizeof(int));
+        std::memcpy(to, p + (1 + n) * k * sizeof(int), n * k * sizeof(int));
+        return true;
+    }
+    // write the landmarks and the tables to the cache file 'path'
+    void save(const char* path, const CSRGraph& graph) const {
+        const int fd{open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+        if (fd == -1) {
+            io_fail("open", path);
+        }
+        LandmarksHeader header;
+        std::memcpy(header.magic, "LANDMARK", sizeof(header.magic));
+        header.version = LANDMARKS_VERSION;
+        header.byte_order = SNAPSHOT_BYTE_ORDER;
+        header.n = n;
+        header.m = graph.m;
+        header.k = k;
+        header.fingerprint = graph_fingerprint(graph);
+        write_all(fd, &header, sizeof(header), path);
+        write_all(fd, landmarks, k * sizeof(int), path);
+        write_all(fd, from, n * k * sizeof(int), path);
+        write_all(fd, to, n * k * sizeof(int), path);
+        if (close(fd) != 0) {
+            io_fail("close", path);
+        }
+    }
+
+  public:
+    // Constructor, chooses 'num_landmarks' landmarks of 'graph', whose reverse is 'reverse', and computes their tables
+    // on 'threads' threads. If 'cache' is not null, the landmarks and the tables are read from that file when it
+    // holds the ones of the same graph, and otherwise computed and written to it
+    Landmarks(const CSRGraph& graph, const CSRGraph& reverse, const std::size_t num_landmarks, const char* cache=nullptr,
+              const std::size_t threads=default_threads()) :
+        n{graph.n}, k{num_landmarks < graph.n ? num_landmarks : graph.n}, landmarks{new int[k]}, from{new int[n * k]}, to{new int[n * k]} {
+        if (k == 0 || (cache != nullptr && load(cache, graph))) {
+            return;
+        }
+        compute(graph, reverse, threads);
+        if (cache != nullptr) {
+            save(cache, graph);
+        }
+    }
+    Landmarks(const Landmarks&) = delete;
+    Landmarks& operator=(const Landmarks&) = delete;
+    // number of landmarks
+    std::size_t size() const noexcept {
+        return k;
+    }
+    // the i-th landmark
+    int landmark(const std::size_t i) const noexcept {
+        return landmarks[i];
+    }
+    int operator()(const int v, const int t) const noexcept {
+        const int* from_v{from + static_cast<std::size_t>(v) * k};
+        const int* from_t{from + static_cast<std::size_t>(t) * k};
+        const int* to_v{to + static_cast<std::size_t>(v) * k};
+        const int* to_t{to + static_cast<std::size_t>(t) * k};
+        int bound{0};
+        for (std::size_t i=0; i < k; ++i) {
+            if (from_v[i] != INT_MAX && from_t[i] != INT_MAX && from_t[i] - from_v[i] > bound) {
+                bound = from_t[i] - from_v[i];
+            }
+            if (to_v[i] != INT_MAX && to_t[i] != INT_MAX && to_v[i] - to_t[i] > bound) {
+                bound = to_v[i] - to_t[i];
+            }
+        }
+        return bound;
+    }
+    // Destructor
+    ~Landmarks() {
+        delete[] landmarks;
+        delete[] from;
+        delete[] to;
+    }
+};
+
+#endif  // __HEURISTICS__
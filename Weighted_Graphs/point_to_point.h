@@ -0,0 +1,123 @@
+#ifndef __POINT_TO_POINT__
+#define __POINT_TO_POINT__
+
+/**
+  * This header file contains the point-to-point shortest path queries on graphs in CSR form: rather than settling
+  * every vertex like dijkstra does, they stop as soon as the distance from 's' to 't' is known
+  */
+
+#include <climits>
+
+#include "graph_utilities.h"
+#include "csr_graph.h"
+#include "dijkstra_workspace.h"
+
+/**
+  * Bidirectional Dijkstra's algorithm: find a shortest path from 's' to 't' in the CSR 'graph', whose reverse is
+  * 'reverse' (see CSRGraph::reverse), and store it in 'path'; returns its length, INT_MAX if 't' cannot be reached.
+  * A forward search from 's' on the graph and a backward search from 't' on the reverse graph settle one vertex each
+  * in turn, in the workspaces 'forward' and 'backward', which must have room for graph.n vertices and are reused from
+  * one query to the next, so a query costs time in the vertices it reaches rather than in the size of the graph.
+  * Every edge u -> v scanned by one search towards a vertex already reached by the other gives a path through it,
+  * and the shortest of them, mu, is kept. Since the searches settle their keys in non-decreasing order, the next key
+  * of one search plus the last one settled by the other is a lower bound on top_f + top_b, the sum of the minima of
+  * the two queues; once it reaches mu, no path can be shorter than mu and the query stops. Each search then covers a
+  * ball of radius about half the distance, usually a small fraction of the vertices the whole dijkstra would settle.
+  * The path goes from 's' to the vertex where mu was found through the forward predecessors, then on to 't' through
+  * the backward ones, which point towards 't'.
+  */
+inline int bidirectional_dijkstra(const CSRGraph& graph, const CSRGraph& reverse, const int s, const int t,
+                                  DijkstraWorkspace& forward, DijkstraWorkspace& backward, ShortestPath& path) {
+    path.reset(0);
+    forward.start(s);
+    backward.start(t);
+    long long mu{(s == t) ? 0 : LLONG_MAX};  // length of the shortest path found so far
+    int middle{(s == t) ? s : -1};  // the vertex where that path passes from the forward to the backward search
+    long long last[2]{0, 0};  // the last key settled by each search
+    DijkstraWorkspace* searches[2]{&forward, &backward};
+    // search 0 is the forward one, search 1 the backward one; they alternate until one of them runs out of vertices
+    for (int side=0; mu > 0; side = 1 - side) {
+        DijkstraWorkspace& mine = *searches[side];
+        const DijkstraWorkspace& other = *searches[1 - side];
+        const CSRGraph& edges = (side == 0) ? graph : reverse;
+        // the rest of the graph cannot be reached from this side, or no shorter path is left
+        if (mine.is_done() || mine.next_key() + last[1 - side] >= mu) {
+            break;
+        }
+        const int u{mine.settle()};
+        last[side] = mine.distance(u);
+        ++path.settled;
+        for (std::size_t e=edges.offsets[u]; e < edges.offsets[u + 1]; ++e) {
+            const int v{edges.targets[e]};
+            const long long d{static_cast<long long>(last[side]) + edges.weights[e]};
+            if (!mine.is_settled(v) && d < mine.distance(v)) {
+                mine.lower(v, static_cast<int>(d), u, static_cast<int>(d));
+            }
+            // a path through the edge u -> v, if the other search has reached v
+            if (other.distance(v) != INT_MAX && d + other.distance(v) < mu) {
+                mu = d + other.distance(v);
+                middle = v;
+            }
+        }
+    }
+    if (middle != -1) {
+        path.distance = static_cast<int>(mu);
+        // from the middle back to s, then reversed, then on to t
+        for (int v=middle; v != -1; v = forward.predecessor(v)) {
+            path.push(v);
+        }
+        for (std::size_t i=0, j=path.length - 1; i < j; ++i, --j) {
+            const int tmp{path.vertices[i]};
+            path.vertices[i] = path.vertices[j];
+            path.vertices[j] = tmp;
+        }
+        for (int v=backward.predecessor(middle); v != -1; v = backward.predecessor(v)) {
+            path.push(v);
+        }
+    }
+    return path.distance;
+}
+
+/**
+  * The heuristic of plain Dijkstra's algorithm: with it, astar settles the vertices in the same order as dijkstra
+  * and stops at the target
+  */
+struct ZeroHeuristic {
+    int operator()(const int, const int) const noexcept {
+        return 0;
+    }
+};
+
+/**
+  * A* search: find a shortest path from 's' to 't' in the CSR 'graph' and store it in 'path'; returns its length,
+  * INT_MAX if 't' cannot be reached. 'heuristic(v, t)' must return a lower bound on the distance from v to t that is
+  * also consistent, that is never larger than w + heuristic(x, t) for an edge v -> x of weight w (see heuristics.h).
+  * The search is Dijkstra's algorithm on the reduced weights w - h(v) + h(x), which are non-negative for a
+  * consistent heuristic, run in 'workspace', which must have room for graph.n vertices and is reused from one query
+  * to the next: the workspace keeps the distance of each vertex from 's', and queues it with that distance plus its
+  * estimated distance to 't', so the vertices closer to the target come out first and the search stops as soon as
+  * 't' is settled. The better the heuristic, the fewer vertices are settled; with ZeroHeuristic this is dijkstra
+  * stopped at 't'. The heuristic is evaluated each time a shorter path to a vertex is found.
+  */
+template<class Heuristic>
+int astar(const CSRGraph& graph, const int s, const int t, const Heuristic& heuristic, DijkstraWorkspace& workspace, ShortestPath& path) {
+    workspace.start(s, heuristic(s, t));
+    while (!workspace.is_done()) {
+        const int u{workspace.settle()};
+        if (u == t) {
+            break;
+        }
+        const long long du{workspace.distance(u)};
+        for (std::size_t e=graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+            const int v{graph.targets[e]};
+            const long long d{du + graph.weights[e]};
+            if (!workspace.is_settled(v) && d < workspace.distance(v)) {
+                workspace.lower(v, static_cast<int>(d), u, static_cast<int>(d + heuristic(v, t)));
+            }
+        }
+    }
+    workspace.path_to(t, path);
+    return path.distance;
+}
+
+#endif  // __POINT_TO_POINT__